@@ -0,0 +1,28 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __IAM_BENCH_H__
+#define __IAM_BENCH_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static inline double bench_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static inline double bench_rand(double min, double max) {
+    return (double)rand() / RAND_MAX * (max - min) + min;
+}
+
+#define BENCH_RUN(var, repeat, body) do {   \
+    double t0 = bench_now();                \
+    for (int r_ = 0; r_ < repeat; r_++)     \
+        body;                               \
+    var = (bench_now() - t0) / repeat;      \
+} while (0)
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+// Цензурирование кандидатов в детекторы NSA_RV по строкам "своих":
+// перебор строк для каждого кандидата, запрос к дереву шаров и блочная
+// проверка через |x|² + |c|² - 2x·c.
+
+#include "bench.h"
+#include "distance.h"
+#include "tree.h"
+#include "block.h"
+#include <stdint.h>
+
+#define ATTR_N 46
+#define LATENT_N 4
+#define ROW_N 20000
+#define CAND_N 1024
+#define REPEAT 3
+
+static double basis[LATENT_N * ATTR_N];
+static double *rows, *cand, *r;
+static size_t *ids;
+static bool hit_lin[CAND_N], hit_tree[CAND_N], hit_block[CAND_N];
+
+// Точка около подпространства, натянутого на basis
+static void sample(double *x) {
+    double z[LATENT_N];
+    size_t j, l;
+    for (l = 0; l < LATENT_N; l++)
+        z[l] = bench_rand(-2, 2);
+    for (j = 0; j < ATTR_N; j++) {
+        x[j] = bench_rand(-0.05, 0.05);
+        for (l = 0; l < LATENT_N; l++)
+            x[j] += z[l] * basis[l * ATTR_N + j];
+    }
+}
+
+static void censor_linear(void) {
+    size_t b, i;
+    for (b = 0; b < CAND_N; b++) {
+        hit_lin[b] = false;
+        for (i = 0; i < ROW_N && !hit_lin[b]; i++)
+            hit_lin[b] = rv_is_within(cand + b * ATTR_N, rows + i * ATTR_N,
+                ATTR_N, r[b]);
+    }
+}
+
+static void censor_tree(const rv_tree_t *tree) {
+    size_t b;
+    for (b = 0; b < CAND_N; b++)
+        hit_tree[b] = rv_tree_any_within(tree, cand + b * ATTR_N, r[b])
+            != SIZE_MAX;
+}
+
+static void run(const char *name) {
+    size_t b, hits = 0;
+    double t_lin, t_tree, t_block;
+    rv_tree_t *tree = rv_tree_build(rows, ATTR_N, ATTR_N, ids, ROW_N,
+        NULL, 0);
+    rv_rows_t m;
+    rv_rows_init(&m, rows, ATTR_N, ATTR_N, ids, ROW_N);
+    BENCH_RUN(t_lin, REPEAT, censor_linear());
+    BENCH_RUN(t_tree, REPEAT, censor_tree(tree));
+    BENCH_RUN(t_block, REPEAT,
+        rv_block_censor(&m, cand, CAND_N, r, hit_block));
+    for (b = 0; b < CAND_N; b++) {
+        hits += hit_lin[b];
+        if (hit_lin[b] != hit_tree[b] || hit_lin[b] != hit_block[b])
+            printf("mismatch in candidate %zu\n", b);
+    }
+    printf("%-10s %10.4f %10.4f %10.4f %6zu\n",
+        name, t_lin, t_tree, t_block, hits);
+    rv_rows_free(&m);
+    rv_tree_free(tree);
+}
+
+int main(void) {
+    size_t i;
+    rows = malloc(sizeof(double) * ROW_N * ATTR_N);
+    cand = malloc(sizeof(double) * CAND_N * ATTR_N);
+    r = malloc(sizeof(double) * CAND_N);
+    ids = malloc(sizeof(size_t) * ROW_N);
+    srand(1);
+    rv_distance_init(RV_SIMD_AUTO);
+    for (i = 0; i < LATENT_N * ATTR_N; i++)
+        basis[i] = bench_rand(-0.5, 0.5);
+    for (i = 0; i < ROW_N; i++)
+        ids[i] = i;
+    printf("%-10s %10s %10s %10s %6s\n",
+        "data", "linear, s", "tree, s", "block, s", "hits");
+    // Кандидаты около данных, часть накрывает строки "своих"
+    for (i = 0; i < CAND_N; i++) {
+        sample(cand + i * ATTR_N);
+        r[i] = bench_rand(0, 0.5);
+    }
+    for (i = 0; i < ROW_N; i++)
+        sample(rows + i * ATTR_N);
+    run("latent");
+    for (i = 0; i < ROW_N * ATTR_N; i++)
+        rows[i] = bench_rand(-2, 2);
+    for (i = 0; i < CAND_N * ATTR_N; i++)
+        cand[i] = bench_rand(-4, 4);
+    for (i = 0; i < CAND_N; i++)
+        r[i] = bench_rand(0, 3);
+    run("uniform");
+    // Большие радиусы: частичные суммы редко позволяют выйти досрочно
+    for (i = 0; i < CAND_N * ATTR_N; i++)
+        cand[i] = bench_rand(-2, 2);
+    for (i = 0; i < CAND_N; i++)
+        r[i] = bench_rand(5, 9);
+    run("wide");
+    free(rows);
+    free(cand);
+    free(r);
+    free(ids);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+// Сравнение реализаций ядра расстояния NSA_RV на сценарии predict
+// (ни один детектор не срабатывает - полный перебор), без отсечения
+// и с отсечением детекторов по нормам.
+
+#include "bench.h"
+#include "distance.h"
+#include <stdint.h>
+
+#define ATTR_N 46
+#define STRIDE 48
+#define DET_N 5000
+#define ROW_N 500
+#define REPEAT 3
+
+static double *detectors, *r, *norm, *inX;
+static uint8_t outY[ROW_N];
+
+static void predict_ref(void) {
+    size_t i, k;
+    for (i = 0; i < ROW_N; i++) {
+        outY[i] = 0;
+        for (k = 0; k < DET_N; k++)
+            if (rv_dist_ref(detectors + k * STRIDE, inX + i * ATTR_N,
+                    ATTR_N) < r[k]) {
+                outY[i] = 1;
+                break;
+            }
+    }
+}
+
+static void predict_simd(void) {
+    size_t i, k;
+    for (i = 0; i < ROW_N; i++) {
+        outY[i] = 0;
+        for (k = 0; k < DET_N; k++)
+            if (rv_is_inside(detectors + k * STRIDE, inX + i * ATTR_N,
+                    ATTR_N, r[k])) {
+                outY[i] = 1;
+                break;
+            }
+    }
+}
+
+// Отсечение детекторов по нормам перед вычислением расстояния
+static void predict_norm(void) {
+    size_t i, k;
+    double norm_x;
+    for (i = 0; i < ROW_N; i++) {
+        outY[i] = 0;
+        norm_x = rv_norm(inX + i * ATTR_N, ATTR_N);
+        for (k = 0; k < DET_N; k++) {
+            if (rv_is_far(norm[k], norm_x, r[k]))
+                continue;
+            if (rv_is_inside(detectors + k * STRIDE, inX + i * ATTR_N,
+                    ATTR_N, r[k])) {
+                outY[i] = 1;
+                break;
+            }
+        }
+    }
+}
+
+int main(void) {
+    size_t i;
+    rv_simd_t simd, got;
+    double t_ref, t;
+    detectors = malloc(sizeof(double) * DET_N * STRIDE);
+    r = malloc(sizeof(double) * DET_N);
+    norm = malloc(sizeof(double) * DET_N);
+    inX = malloc(sizeof(double) * ROW_N * ATTR_N);
+    srand(1);
+    for (i = 0; i < DET_N * STRIDE; i++)
+        detectors[i] = bench_rand(-4, 4);
+    for (i = 0; i < DET_N; i++) {
+        r[i] = bench_rand(0, 0.5);
+        norm[i] = rv_norm(detectors + i * STRIDE, ATTR_N);
+    }
+    for (i = 0; i < ROW_N * ATTR_N; i++)
+        inX[i] = bench_rand(-4, 4);
+    BENCH_RUN(t_ref, REPEAT, predict_ref());
+    printf("%-8s %10.4f s\n", "pow+sqrt", t_ref);
+    for (simd = RV_SIMD_SCALAR; simd < RV_SIMD_AUTO; simd++) {
+        got = rv_distance_init(simd);
+        if (got != simd)
+            continue;
+        BENCH_RUN(t, REPEAT, predict_simd());
+        printf("%-8s %10.4f s %8.2fx\n", rv_distance_name(got), t, t_ref / t);
+        BENCH_RUN(t, REPEAT, predict_norm());
+        printf("%-8s %10.4f s %8.2fx (norm)\n", rv_distance_name(got), t,
+            t_ref / t);
+    }
+    free(detectors);
+    free(r);
+    free(norm);
+    free(inX);
+    return 0;
+}
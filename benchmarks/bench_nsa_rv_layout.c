@@ -0,0 +1,123 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+// Сравнение хранения детекторов NSA_RV: отдельные строки (double **)
+// и единый выровненный блок [det_n X stride].
+
+#include "bench.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#define ATTR_N 46
+#define ROW_N 1000
+#define REPEAT 3
+#define ALIGN 64
+
+static size_t predict_rows(double **detectors, const double *r,
+    const double *inX, uint8_t *outY, size_t det_n) {
+    size_t i, j, k, hits = 0;
+    double euclidean;
+    for (i = 0; i < ROW_N; i++, inX += ATTR_N) {
+        outY[i] = 0;
+        for (k = 0; k < det_n; k++) {
+            euclidean = 0;
+            for (j = 0; j < ATTR_N; j++)
+                euclidean += pow(detectors[k][j] - inX[j], 2);
+            if (sqrt(euclidean) < r[k]) {
+                outY[i] = 1;
+                hits++;
+                break;
+            }
+        }
+    }
+    return hits;
+}
+
+static size_t predict_block(const double *detectors, size_t stride,
+    const double *r, const double *inX, uint8_t *outY, size_t det_n) {
+    size_t i, j, k, hits = 0;
+    double euclidean;
+    const double *detector;
+    for (i = 0; i < ROW_N; i++, inX += ATTR_N) {
+        outY[i] = 0;
+        for (k = 0, detector = detectors; k < det_n; k++, detector += stride) {
+            euclidean = 0;
+            for (j = 0; j < ATTR_N; j++)
+                euclidean += pow(detector[j] - inX[j], 2);
+            if (sqrt(euclidean) < r[k]) {
+                outY[i] = 1;
+                hits++;
+                break;
+            }
+        }
+    }
+    return hits;
+}
+
+static void *aligned_new(size_t size) {
+#ifdef _WIN32
+    return _aligned_malloc(size, ALIGN);
+#else
+    void *p;
+    return posix_memalign(&p, ALIGN, size) == 0 ? p : NULL;
+#endif
+}
+
+static void aligned_free(void *p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+static void run(size_t det_n) {
+    size_t i, j, hits_rows = 0, hits_block = 0;
+    size_t stride = (ATTR_N * sizeof(double) + ALIGN - 1) / ALIGN
+        * ALIGN / sizeof(double);
+    double t_rows, t_block;
+    double **rows = malloc(sizeof(double *) * det_n);
+    void **noise = malloc(sizeof(void *) * det_n);
+    double *block = aligned_new(sizeof(double) * det_n * stride);
+    double *r = malloc(sizeof(double) * det_n);
+    double *inX = malloc(sizeof(double) * ROW_N * ATTR_N);
+    uint8_t *outY = malloc(ROW_N);
+    for (i = 0; i < det_n; i++) {
+        rows[i] = malloc(sizeof(double) * ATTR_N);
+        // Имитация фрагментации кучи между выделениями строк
+        noise[i] = malloc(16 + rand() % 256);
+        for (j = 0; j < ATTR_N; j++)
+            block[i * stride + j] = rows[i][j] = bench_rand(-4, 4);
+        for (; j < stride; j++)
+            block[i * stride + j] = 0;
+        r[i] = bench_rand(0, 0.5);
+    }
+    for (i = 0; i < ROW_N * ATTR_N; i++)
+        inX[i] = bench_rand(-4, 4);
+    BENCH_RUN(t_rows, REPEAT,
+        hits_rows = predict_rows(rows, r, inX, outY, det_n));
+    BENCH_RUN(t_block, REPEAT,
+        hits_block = predict_block(block, stride, r, inX, outY, det_n));
+    printf("%8zu %12.4f %12.4f %8.2fx %s\n", det_n, t_rows, t_block,
+        t_rows / t_block, hits_rows == hits_block ? "ok" : "MISMATCH");
+    for (i = 0; i < det_n; i++) {
+        free(rows[i]);
+        free(noise[i]);
+    }
+    free(rows);
+    free(noise);
+    aligned_free(block);
+    free(r);
+    free(inX);
+    free(outY);
+}
+
+int main(void) {
+    size_t det_n[] = { 200, 1000, 5000, 20000 };
+    srand(1);
+    printf("%8s %12s %12s %9s\n", "det_n", "rows, s", "block, s", "speedup");
+    for (size_t i = 0; i < sizeof(det_n) / sizeof(*det_n); i++)
+        run(det_n[i]);
+    return 0;
+}
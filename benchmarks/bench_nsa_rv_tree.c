@@ -0,0 +1,106 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+// Перебор детекторов NSA_RV (SIMD и отсечение по нормам) в сравнении
+// с поиском по дереву шаров при росте количества детекторов.
+// Данные сосредоточены около подпространства малой размерности, как
+// признаки с сильной корреляцией; детекторы не срабатывают на большинстве
+// строк.
+
+#include "bench.h"
+#include "distance.h"
+#include "tree.h"
+#include <stdint.h>
+
+#define ATTR_N 46
+#define LATENT_N 4
+#define ROW_N 2000
+#define REPEAT 3
+
+static double basis[LATENT_N * ATTR_N];
+static double *detectors, *r, *norm, *inX;
+static size_t *ids;
+static uint8_t outY[ROW_N], outT[ROW_N];
+
+// Точка около подпространства, натянутого на basis
+static void sample(double *x) {
+    double z[LATENT_N];
+    size_t j, l;
+    for (l = 0; l < LATENT_N; l++)
+        z[l] = bench_rand(-2, 2);
+    for (j = 0; j < ATTR_N; j++) {
+        x[j] = bench_rand(-0.05, 0.05);
+        for (l = 0; l < LATENT_N; l++)
+            x[j] += z[l] * basis[l * ATTR_N + j];
+    }
+}
+
+static void predict_linear(size_t det_n) {
+    size_t i, k;
+    double norm_x;
+    const double *x;
+    for (i = 0; i < ROW_N; i++) {
+        x = inX + i * ATTR_N;
+        outY[i] = 0;
+        norm_x = rv_norm(x, ATTR_N);
+        for (k = 0; k < det_n; k++) {
+            if (rv_is_far(norm[k], norm_x, r[k]))
+                continue;
+            if (rv_is_inside(detectors + k * ATTR_N, x, ATTR_N, r[k])) {
+                outY[i] = 1;
+                break;
+            }
+        }
+    }
+}
+
+static void predict_tree(const rv_tree_t *tree) {
+    size_t i;
+    for (i = 0; i < ROW_N; i++)
+        outT[i] = rv_tree_find(tree, inX + i * ATTR_N) != SIZE_MAX;
+}
+
+int main(void) {
+    size_t det_max = 100000, det_n, i, hits;
+    double t_lin, t_tree, t_build;
+    rv_tree_t *tree;
+    detectors = malloc(sizeof(double) * det_max * ATTR_N);
+    r = malloc(sizeof(double) * det_max);
+    norm = malloc(sizeof(double) * det_max);
+    ids = malloc(sizeof(size_t) * det_max);
+    inX = malloc(sizeof(double) * ROW_N * ATTR_N);
+    srand(1);
+    rv_distance_init(RV_SIMD_AUTO);
+    for (i = 0; i < LATENT_N * ATTR_N; i++)
+        basis[i] = bench_rand(-0.5, 0.5);
+    for (i = 0; i < det_max; i++) {
+        sample(detectors + i * ATTR_N);
+        r[i] = bench_rand(0, 0.3);
+        norm[i] = rv_norm(detectors + i * ATTR_N, ATTR_N);
+        ids[i] = i;
+    }
+    for (i = 0; i < ROW_N; i++)
+        sample(inX + i * ATTR_N);
+    printf("%8s %10s %10s %10s %8s %6s\n",
+        "det_n", "linear, s", "tree, s", "build, s", "speedup", "hits");
+    for (det_n = 100; det_n <= det_max; det_n *= 10) {
+        BENCH_RUN(t_build, 1, tree = rv_tree_build(detectors, ATTR_N,
+            ATTR_N, ids, det_n, r, 0));
+        BENCH_RUN(t_lin, REPEAT, predict_linear(det_n));
+        BENCH_RUN(t_tree, REPEAT, predict_tree(tree));
+        for (i = 0, hits = 0; i < ROW_N; i++) {
+            hits += outY[i];
+            if (outY[i] != outT[i])
+                printf("mismatch in row %zu\n", i);
+        }
+        printf("%8zu %10.4f %10.4f %10.4f %7.2fx %6zu\n",
+            det_n, t_lin, t_tree, t_build, t_lin / t_tree, hits);
+        rv_tree_free(tree);
+    }
+    free(detectors);
+    free(r);
+    free(norm);
+    free(ids);
+    free(inX);
+    return 0;
+}
\ No newline at end of file
@@ -7,28 +7,29 @@
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 #include <numpy/arrayobject.h>
 
-void set_mode(const char *alg_name, const char* mode, uint8_t det_id) {
+// Пункты настройки NSA_RV находятся один раз после iam_init
+static iam_setting_t *is_vdetectors = NULL, *det_id_s = NULL;
+
+static void find_settings(void) {
     iam_id_t id;
-    iam_setting_t *s;
     iam_module_rewind();
     while(id = iam_module_read())
-        if (strcmp(alg_name, id->info->name) == 0) {
-            if (strcmp(alg_name, "NSA_RV") == 0) {
-                iam_setting_rewind(id);
-                while (s = iam_setting_read(id)) {
-                    if (strcmp(s->info->name, "isVdetectors") == 0) {
-                        iam_setting_set_bool(s, 
-                            strcmp(mode, "Vdetectors") == 0);
-                    }
-                    if (strcmp(s->info->name, "det_id") == 0) {
-                        iam_setting_set_uint8(s, det_id);
-                    }
-                }
-            }   
+        if (strcmp(id->info->name, "NSA_RV") == 0) {
+            is_vdetectors = iam_setting_find(id, "isVdetectors");
+            det_id_s = iam_setting_find(id, "det_id");
             break;
         }
 }
 
+void set_mode(const char *alg_name, const char* mode, uint8_t det_id) {
+    if (strcmp(alg_name, "NSA_RV") != 0)
+        return;
+    if (is_vdetectors != NULL)
+        iam_setting_set_bool(is_vdetectors, strcmp(mode, "Vdetectors") == 0);
+    if (det_id_s != NULL)
+        iam_setting_set_uint8(det_id_s, det_id);
+}
+
 static PyObject *fit(PyObject* self, PyObject* args) {
     PyObject *argX, *argY;
     PyArrayObject *arrX, *arrY;
@@ -95,10 +96,12 @@ static PyObject *predict(PyObject* self, PyObject* args) {
 
 static PyObject *init_lib(PyObject* self, PyObject* args) {
     iam_init();
+    find_settings();
     Py_RETURN_NONE;
 }
 
 static PyObject *exit_lib(PyObject* self, PyObject* args) {  
+    is_vdetectors = det_id_s = NULL;
     iam_exit();
     Py_RETURN_NONE;
 }
@@ -10,6 +10,7 @@
 #define __IAM_ALGORITHM_H__
 
 #include "iam.h"
+#include "worker.h"
 #include <stddef.h>
 #include <stdbool.h>
 #include <inttypes.h>
@@ -48,6 +49,44 @@ typedef void (*iam_real_generate_fn)
 typedef bool (*iam_real_analyze_fn)
      (iam_id_t id, const double *vector, size_t k);
 
+/*! Пакетная генерация детекторов на основе бинарного кодирования.
+    \param id Идентификатор плагина.
+    \param data Наборы байт [n].
+    \param size Количество байт в каждом наборе [n].
+    \param n Количество наборов.
+*/
+typedef void (*iam_binary_generate_batch_fn)(iam_id_t id,
+    const char *const *data, const size_t *size, size_t n);
+
+/*! Пакетный анализ на основе детекторов с бинарным кодированием.
+    \param id Идентификатор плагина.
+    \param data Наборы байт [n].
+    \param size Количество байт в каждом наборе [n].
+    \param n Количество наборов.
+    \param out Результаты анализа [n]: 0 - аномалий не найдено.
+*/
+typedef void (*iam_binary_analyze_batch_fn)(iam_id_t id,
+    const char *const *data, const size_t *size, size_t n, uint8_t *out);
+
+/*! Пакетная генерация детекторов на основе вещественного кодирования.
+    \param id Идентификатор плагина.
+    \param vectors Векторы данных [n X k].
+    \param n Количество векторов.
+    \param k Количество измерений вектора.
+*/
+typedef void (*iam_real_generate_batch_fn)(iam_id_t id,
+    const double *vectors, size_t n, size_t k);
+
+/*! Пакетный анализ на основе детекторов с вещественным кодированием.
+    \param id Идентификатор плагина.
+    \param vectors Векторы данных [n X k].
+    \param n Количество векторов.
+    \param k Количество измерений вектора.
+    \param out Результаты анализа [n]: 0 - аномалий не найдено.
+*/
+typedef void (*iam_real_analyze_batch_fn)(iam_id_t id,
+    const double *vectors, size_t n, size_t k, uint8_t *out);
+
 /*! Функция для обучения алгоритма
     \param inX Матрица данных [row_n X col_n]
     \param inY Список меток [row_n]
@@ -66,9 +105,55 @@ typedef void (*iam_real_fit_fn)(const double *inX, const uint8_t *inY,
 typedef void (*iam_real_predict_fn)(const double *inX, uint8_t *outY,
     size_t row_n, size_t col_n);
 
+/*! Создаёт экземпляр алгоритма (ABI с контекстом).
+    Экземпляр получает текущие настройки плагина и дальше от них не зависит.
+    \param id Идентификатор плагина.
+    \param name Имя экземпляра или NULL.
+    \return Контекст экземпляра или NULL при ошибке.
+*/
+typedef void *(*iam_instance_create_fn)(iam_id_t id, const char *name);
+
+/*! Уничтожает экземпляр алгоритма.
+    \param id Идентификатор плагина.
+    \param ctx Контекст экземпляра.
+*/
+typedef void (*iam_instance_destroy_fn)(iam_id_t id, void *ctx);
+
+/*! Функции ABI с контекстом: те же, что и без него, но первым параметром
+    получают контекст экземпляра, созданный iam_instance_create_fn.
+*/
+typedef void (*iam_binary_generate_ctx_fn)
+     (void *ctx, const char *data, size_t size);
+typedef bool (*iam_binary_analyze_ctx_fn)
+     (void *ctx, const char *data, size_t size);
+typedef void (*iam_real_generate_ctx_fn)
+     (void *ctx, const double *vector, size_t k);
+typedef bool (*iam_real_analyze_ctx_fn)
+     (void *ctx, const double *vector, size_t k);
+typedef void (*iam_real_fit_ctx_fn)(void *ctx, const double *inX,
+    const uint8_t *inY, size_t row_n, size_t col_n);
+typedef void (*iam_real_predict_ctx_fn)(void *ctx, const double *inX,
+    uint8_t *outY, size_t row_n, size_t col_n);
+typedef void (*iam_binary_generate_batch_ctx_fn)(void *ctx,
+    const char *const *data, const size_t *size, size_t n);
+typedef void (*iam_binary_analyze_batch_ctx_fn)(void *ctx,
+    const char *const *data, const size_t *size, size_t n, uint8_t *out);
+typedef void (*iam_real_generate_batch_ctx_fn)(void *ctx,
+    const double *vectors, size_t n, size_t k);
+typedef void (*iam_real_analyze_batch_ctx_fn)(void *ctx,
+    const double *vectors, size_t n, size_t k, uint8_t *out);
+
 typedef struct {
     iam_binary_generate_fn generate;
     iam_binary_analyze_fn analyze;
+    iam_instance_create_fn create;
+    iam_instance_destroy_fn destroy;
+    iam_binary_generate_ctx_fn generate_ctx;
+    iam_binary_analyze_ctx_fn analyze_ctx;
+    iam_binary_generate_batch_fn generate_batch;
+    iam_binary_analyze_batch_fn analyze_batch;
+    iam_binary_generate_batch_ctx_fn generate_batch_ctx;
+    iam_binary_analyze_batch_ctx_fn analyze_batch_ctx;
 } iam_binary_alg_t;
 
 typedef struct {
@@ -76,8 +161,25 @@ typedef struct {
     iam_real_analyze_fn analyze;
     iam_real_fit_fn fit;
     iam_real_predict_fn predict;
+    bool is_parallel;   //!< true - строки predict обрабатываются независимо.
+    iam_instance_create_fn create;
+    iam_instance_destroy_fn destroy;
+    iam_real_generate_ctx_fn generate_ctx;
+    iam_real_analyze_ctx_fn analyze_ctx;
+    iam_real_fit_ctx_fn fit_ctx;
+    iam_real_predict_ctx_fn predict_ctx;
+    iam_real_generate_batch_fn generate_batch;
+    iam_real_analyze_batch_fn analyze_batch;
+    iam_real_generate_batch_ctx_fn generate_batch_ctx;
+    iam_real_analyze_batch_ctx_fn analyze_batch_ctx;
 } iam_real_alg_t;
 
+//! Экземпляр бинарного алгоритма.
+typedef struct iam_binary_inst_s iam_binary_inst_t;
+
+//! Экземпляр вещественного алгоритма.
+typedef struct iam_real_inst_s iam_real_inst_t;
+
 /*! Возвращает идентификатор для регистрации компонентов бинарного алгоритма.
     \param id Идентификатор плагина.
     \return Идентификатор для бинарного алгоритма.
@@ -118,6 +220,28 @@ IAM_API void iam_real_alg_reg_generate(iam_real_alg_t *alg,
 IAM_API void iam_real_alg_reg_analyze(iam_real_alg_t *alg,
     iam_real_analyze_fn fn);
 
+/*! Регистрирует функции пакетной генерации и анализа на основе бинарного
+    кодирования. Функция, равная NULL, не меняет зарегистрированную ранее.
+    Если пакетной функции нет, пакет обрабатывается в цикле обычной.
+    \param alg Идентификатор алгоритма.
+    \param generate Функция пакетной генерации детекторов.
+    \param analyze Функция пакетного анализа данных.
+*/
+IAM_API void iam_binary_alg_reg_batch(iam_binary_alg_t *alg,
+    iam_binary_generate_batch_fn generate,
+    iam_binary_analyze_batch_fn analyze);
+
+/*! Регистрирует функции пакетной генерации и анализа на основе
+    вещественного кодирования. Функция, равная NULL, не меняет
+    зарегистрированную ранее. Если пакетной функции нет, пакет
+    обрабатывается в цикле обычной.
+    \param alg Идентификатор алгоритма.
+    \param generate Функция пакетной генерации детекторов.
+    \param analyze Функция пакетного анализа данных.
+*/
+IAM_API void iam_real_alg_reg_batch(iam_real_alg_t *alg,
+    iam_real_generate_batch_fn generate, iam_real_analyze_batch_fn analyze);
+
 /*! Регистрирует функцию для передачи данных на обучение.
     \param alg Идентификатор алгоритма.
     \param fn Функция генерации детекторов.
@@ -132,6 +256,145 @@ IAM_API void iam_real_alg_reg_fit(iam_real_alg_t *alg,
 IAM_API void iam_real_alg_reg_predict(iam_real_alg_t *alg,
     iam_real_predict_fn fn);
 
+/*! Разрешает libIAM делить матрицу predict на части по строкам и
+    обрабатывать их одновременно в нескольких потоках (настройка "threads").
+    Функция predict алгоритма при этом должна быть потокобезопасной.
+    \param alg Идентификатор алгоритма.
+    \param is_parallel true - строки обрабатываются независимо друг от друга.
+*/
+IAM_API void iam_real_alg_reg_parallel(iam_real_alg_t *alg, bool is_parallel);
+
+/*! Регистрирует функции создания и уничтожения экземпляров алгоритма.
+    \param alg Идентификатор алгоритма.
+    \param create Функция создания экземпляра.
+    \param destroy Функция уничтожения экземпляра.
+*/
+IAM_API void iam_binary_alg_reg_instance(iam_binary_alg_t *alg,
+    iam_instance_create_fn create, iam_instance_destroy_fn destroy);
+
+/*! Регистрирует функции бинарного алгоритма, получающие контекст.
+    Функция, равная NULL, не меняет зарегистрированную ранее.
+    \param alg Идентификатор алгоритма.
+*/
+IAM_API void iam_binary_alg_reg_ctx(iam_binary_alg_t *alg,
+    iam_binary_generate_ctx_fn generate, iam_binary_analyze_ctx_fn analyze);
+
+/*! Регистрирует пакетные функции бинарного алгоритма, получающие контекст.
+    Функция, равная NULL, не меняет зарегистрированную ранее.
+    \param alg Идентификатор алгоритма.
+*/
+IAM_API void iam_binary_alg_reg_batch_ctx(iam_binary_alg_t *alg,
+    iam_binary_generate_batch_ctx_fn generate,
+    iam_binary_analyze_batch_ctx_fn analyze);
+
+/*! Регистрирует функции создания и уничтожения экземпляров алгоритма.
+    \param alg Идентификатор алгоритма.
+    \param create Функция создания экземпляра.
+    \param destroy Функция уничтожения экземпляра.
+*/
+IAM_API void iam_real_alg_reg_instance(iam_real_alg_t *alg,
+    iam_instance_create_fn create, iam_instance_destroy_fn destroy);
+
+/*! Регистрирует функции вещественного алгоритма, получающие контекст.
+    Функция, равная NULL, не меняет зарегистрированную ранее.
+    Для fit_ctx и predict_ctx действует iam_real_alg_reg_parallel.
+    \param alg Идентификатор алгоритма.
+*/
+IAM_API void iam_real_alg_reg_ctx(iam_real_alg_t *alg,
+    iam_real_generate_ctx_fn generate, iam_real_analyze_ctx_fn analyze,
+    iam_real_fit_ctx_fn fit, iam_real_predict_ctx_fn predict);
+
+/*! Регистрирует пакетные функции вещественного алгоритма, получающие
+    контекст. Функция, равная NULL, не меняет зарегистрированную ранее.
+    \param alg Идентификатор алгоритма.
+*/
+IAM_API void iam_real_alg_reg_batch_ctx(iam_real_alg_t *alg,
+    iam_real_generate_batch_ctx_fn generate,
+    iam_real_analyze_batch_ctx_fn analyze);
+
+/*! Ищет бинарный алгоритм по имени плагина.
+    Если плагинов с таким именем несколько, возвращается первый
+    зарегистрированный алгоритм.
+    \param alg_name Имя алгоритма
+    \return Идентификатор алгоритма, действительный до iam_exit,
+        или NULL, если алгоритм не найден.
+*/
+IAM_API iam_binary_alg_t *iam_binary_alg_find(const char *alg_name);
+
+/*! Ищет вещественный алгоритм по имени плагина.
+    Найденный идентификатор можно передавать в iam_real_alg_run_fit и
+    iam_real_alg_run_predict без повторного поиска по имени.
+    \param alg_name Имя алгоритма
+    \return Идентификатор алгоритма, действительный до iam_exit,
+        или NULL, если алгоритм не найден.
+*/
+IAM_API iam_real_alg_t *iam_real_alg_find(const char *alg_name);
+
+/*! Передаёт пакет наборов байт для генерации детекторов алгоритму,
+    найденному iam_binary_alg_find.
+    \param alg Идентификатор алгоритма (NULL игнорируется)
+    \param data Наборы байт [n]
+    \param size Количество байт в каждом наборе [n]
+    \param n Количество наборов
+*/
+IAM_API void iam_binary_alg_run_generate_batch(const iam_binary_alg_t *alg,
+    const char *const *data, const size_t *size, size_t n);
+
+/*! Передаёт пакет наборов байт на анализ алгоритму,
+    найденному iam_binary_alg_find.
+    \param alg Идентификатор алгоритма (NULL - аномалий не найдено)
+    \param data Наборы байт [n]
+    \param size Количество байт в каждом наборе [n]
+    \param n Количество наборов
+    \param out Результаты анализа [n]: 0 - аномалий не найдено
+    \return Количество наборов с аномалиями.
+*/
+IAM_API size_t iam_binary_alg_run_analyze_batch(const iam_binary_alg_t *alg,
+    const char *const *data, const size_t *size, size_t n, uint8_t *out);
+
+/*! Передаёт пакет векторов для генерации детекторов алгоритму,
+    найденному iam_real_alg_find.
+    \param alg Идентификатор алгоритма (NULL игнорируется)
+    \param vectors Векторы данных [n X k]
+    \param n Количество векторов
+    \param k Количество измерений вектора
+*/
+IAM_API void iam_real_alg_run_generate_batch(const iam_real_alg_t *alg,
+    const double *vectors, size_t n, size_t k);
+
+/*! Передаёт пакет векторов на анализ алгоритму,
+    найденному iam_real_alg_find.
+    \param alg Идентификатор алгоритма (NULL - аномалий не найдено)
+    \param vectors Векторы данных [n X k]
+    \param n Количество векторов
+    \param k Количество измерений вектора
+    \param out Результаты анализа [n]: 0 - аномалий не найдено
+    \return Количество векторов с аномалиями.
+*/
+IAM_API size_t iam_real_alg_run_analyze_batch(const iam_real_alg_t *alg,
+    const double *vectors, size_t n, size_t k, uint8_t *out);
+
+/*! Передаёт данные для обучения алгоритму, найденному iam_real_alg_find.
+    \param alg Идентификатор алгоритма (NULL игнорируется)
+    \param inX Матрица данных [row_n X col_n]
+    \param inY Список меток [row_n]
+    \param row_n Количество строк
+    \param col_n Количество столбцов
+*/
+IAM_API void iam_real_alg_run_fit(const iam_real_alg_t *alg,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n);
+
+/*! Передаёт данные для предсказания метки алгоритму,
+    найденному iam_real_alg_find.
+    \param alg Идентификатор алгоритма (NULL игнорируется)
+    \param inX Матрица данных [row_n X col_n]
+    \param outY Список для записи меток [row_n]
+    \param row_n Количество строк
+    \param col_n Количество столбцов
+*/
+IAM_API void iam_real_alg_run_predict(const iam_real_alg_t *alg,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n);
+
 /*! Передаёт данные для обучения определённому алгоритму
     \param alg_name Имя алгоритма
     \param inX Матрица данных [row_n X col_n]
@@ -152,4 +415,140 @@ IAM_API void iam_real_alg_fit(const char *alg_name,
 IAM_API void iam_real_alg_predict(const char *alg_name,
     const double *inX, uint8_t *outY, size_t row_n, size_t col_n);
 
+/*! Создаёт экземпляр бинарного алгоритма.
+    Если алгоритм не поддерживает экземпляры, все экземпляры используют
+    функции без контекста и общее состояние плагина.
+    Создание и уничтожение экземпляров не потокобезопасны; функции разных
+    экземпляров можно вызывать одновременно.
+    \param alg Идентификатор алгоритма.
+    \param name Имя экземпляра или NULL.
+    \return Экземпляр, действительный до iam_binary_inst_destroy или
+        iam_exit, либо NULL.
+*/
+IAM_API iam_binary_inst_t *iam_binary_inst_create(iam_binary_alg_t *alg,
+    const char *name);
+
+/*! Уничтожает экземпляр бинарного алгоритма (NULL игнорируется).
+*/
+IAM_API void iam_binary_inst_destroy(iam_binary_inst_t *inst);
+
+/*! Передаёт данные для генерации детекторов экземпляру.
+*/
+IAM_API void iam_binary_inst_generate(iam_binary_inst_t *inst,
+    const char *data, size_t size);
+
+/*! Передаёт данные на анализ экземпляру.
+    \return 0 - аномалий не найдено или функции анализа нет.
+*/
+IAM_API bool iam_binary_inst_analyze(iam_binary_inst_t *inst,
+    const char *data, size_t size);
+
+/*! Передаёт пакет наборов байт для генерации детекторов экземпляру.
+*/
+IAM_API void iam_binary_inst_generate_batch(iam_binary_inst_t *inst,
+    const char *const *data, const size_t *size, size_t n);
+
+/*! Передаёт пакет наборов байт на анализ экземпляру.
+    \return Количество наборов с аномалиями.
+*/
+IAM_API size_t iam_binary_inst_analyze_batch(iam_binary_inst_t *inst,
+    const char *const *data, const size_t *size, size_t n, uint8_t *out);
+
+/*! Создаёт экземпляр вещественного алгоритма.
+    Если алгоритм не поддерживает экземпляры, все экземпляры используют
+    функции без контекста и общее состояние плагина.
+    Создание и уничтожение экземпляров не потокобезопасны; функции разных
+    экземпляров можно вызывать одновременно.
+    \param alg Идентификатор алгоритма.
+    \param name Имя экземпляра или NULL.
+    \return Экземпляр, действительный до iam_real_inst_destroy или
+        iam_exit, либо NULL.
+*/
+IAM_API iam_real_inst_t *iam_real_inst_create(iam_real_alg_t *alg,
+    const char *name);
+
+/*! Уничтожает экземпляр вещественного алгоритма (NULL игнорируется).
+*/
+IAM_API void iam_real_inst_destroy(iam_real_inst_t *inst);
+
+/*! Передаёт вектор для генерации детекторов экземпляру.
+*/
+IAM_API void iam_real_inst_generate(iam_real_inst_t *inst,
+    const double *vector, size_t k);
+
+/*! Передаёт вектор на анализ экземпляру.
+    \return 0 - аномалий не найдено или функции анализа нет.
+*/
+IAM_API bool iam_real_inst_analyze(iam_real_inst_t *inst,
+    const double *vector, size_t k);
+
+/*! Передаёт пакет векторов для генерации детекторов экземпляру.
+*/
+IAM_API void iam_real_inst_generate_batch(iam_real_inst_t *inst,
+    const double *vectors, size_t n, size_t k);
+
+/*! Передаёт пакет векторов на анализ экземпляру.
+    \return Количество векторов с аномалиями.
+*/
+IAM_API size_t iam_real_inst_analyze_batch(iam_real_inst_t *inst,
+    const double *vectors, size_t n, size_t k, uint8_t *out);
+
+/*! Передаёт данные для обучения экземпляру.
+    \param inst Экземпляр (NULL игнорируется)
+    \param inX Матрица данных [row_n X col_n]
+    \param inY Список меток [row_n]
+    \param row_n Количество строк
+    \param col_n Количество столбцов
+*/
+IAM_API void iam_real_inst_fit(iam_real_inst_t *inst,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n);
+
+/*! Передаёт данные для предсказания метки экземпляру.
+    \param inst Экземпляр (NULL игнорируется)
+    \param inX Матрица данных [row_n X col_n]
+    \param outY Список для записи меток [row_n]
+    \param row_n Количество строк
+    \param col_n Количество столбцов
+*/
+IAM_API void iam_real_inst_predict(iam_real_inst_t *inst,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n);
+
+/*! Асинхронно передаёт данные для обучения определённому алгоритму.
+    Матрицы должны оставаться доступными до завершения задания.
+    \param alg_name Имя алгоритма
+    \param inX Матрица данных [row_n X col_n]
+    \param inY Список меток [row_n]
+    \param row_n Количество строк
+    \param col_n Количество столбцов
+    \return Задание (см. iam/worker.h) или NULL при нехватке памяти.
+*/
+IAM_API iam_job_t *iam_real_alg_fit_async(const char *alg_name,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n);
+
+/*! Асинхронно передаёт данные для предсказания метки определённому
+    алгоритму. Матрицы должны оставаться доступными до завершения задания.
+    \param alg_name Имя алгоритма
+    \param inX Матрица данных [row_n X col_n]
+    \param outY Список для записи меток [row_n]
+    \param row_n Количество строк
+    \param col_n Количество столбцов
+    \return Задание (см. iam/worker.h) или NULL при нехватке памяти.
+*/
+IAM_API iam_job_t *iam_real_alg_predict_async(const char *alg_name,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n);
+
+/*! Асинхронно передаёт данные для обучения экземпляру.
+    Экземпляр и матрицы должны оставаться доступными до завершения задания.
+    \return Задание (см. iam/worker.h) или NULL при нехватке памяти.
+*/
+IAM_API iam_job_t *iam_real_inst_fit_async(iam_real_inst_t *inst,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n);
+
+/*! Асинхронно передаёт данные для предсказания метки экземпляру.
+    Экземпляр и матрицы должны оставаться доступными до завершения задания.
+    \return Задание (см. iam/worker.h) или NULL при нехватке памяти.
+*/
+IAM_API iam_job_t *iam_real_inst_predict_async(iam_real_inst_t *inst,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+/*! \file iam/dispatcher.h
+    \brief Распределение данных между алгоритмами.
+
+    Диспетчер передаёт один пакет данных всем подписанным экземплярам
+    алгоритмов одновременно и объединяет их результаты голосованием.
+    Пакет обрабатывается частями: все алгоритмы разбирают одну часть,
+    пока она находится в кэше, и только затем переходят к следующей.
+*/
+#ifndef __IAM_DISPATCHER_H__
+#define __IAM_DISPATCHER_H__
+
+#include "iam.h"
+#include "algorithm.h"
+#include <stddef.h>
+#include <inttypes.h>
+
+/*! Правило объединения результатов алгоритмов.
+*/
+typedef enum {
+    IAM_VOTE_ANY,       //!< Аномалия, если её нашёл хотя бы один алгоритм.
+    IAM_VOTE_ALL,       //!< Аномалия, если её нашли все алгоритмы.
+    IAM_VOTE_MAJORITY   //!< Аномалия, если её нашло больше половины.
+} iam_vote_t;
+
+/*! Пакет данных. Вещественные алгоритмы получают vectors, бинарные -
+    data и size; алгоритмы, для которых данных нет, не голосуют.
+    Все данные только читаются.
+*/
+typedef struct {
+    const double *vectors;      //!< Векторы [n X k] или NULL.
+    size_t k;                   //!< Количество измерений вектора.
+    const char *const *data;    //!< Наборы байт [n] или NULL.
+    const size_t *size;         //!< Количество байт в каждом наборе [n].
+    size_t n;                   //!< Количество элементов пакета.
+} iam_batch_t;
+
+typedef struct iam_dispatcher_s iam_dispatcher_t;
+
+/*! Создаёт диспетчер.
+    \param vote Правило объединения результатов.
+    \return Диспетчер или NULL при нехватке памяти.
+*/
+IAM_API iam_dispatcher_t *iam_dispatcher_create(iam_vote_t vote);
+
+/*! Уничтожает диспетчер; экземпляры алгоритмов не уничтожаются.
+    \param d Диспетчер (NULL игнорируется).
+*/
+IAM_API void iam_dispatcher_destroy(iam_dispatcher_t *d);
+
+/*! Подписывает экземпляр вещественного алгоритма на пакеты.
+    \param d Диспетчер.
+    \param inst Экземпляр, действительный, пока используется диспетчер.
+    \return 0 - успешно, 1 - нехватка памяти.
+*/
+IAM_API int iam_dispatcher_add_real(iam_dispatcher_t *d,
+    iam_real_inst_t *inst);
+
+/*! Подписывает экземпляр бинарного алгоритма на пакеты.
+    \param d Диспетчер.
+    \param inst Экземпляр, действительный, пока используется диспетчер.
+    \return 0 - успешно, 1 - нехватка памяти.
+*/
+IAM_API int iam_dispatcher_add_binary(iam_dispatcher_t *d,
+    iam_binary_inst_t *inst);
+
+/*! Передаёт пакет всем подписанным алгоритмам в потоках libIAM и
+    объединяет их результаты. Разные экземпляры работают одновременно.
+    Части пакета одного экземпляра разбираются одновременно, только если
+    это вещественный алгоритм с iam_real_alg_reg_parallel(alg, true);
+    иначе экземпляр получает части по порядку в одном потоке. Один
+    диспетчер нельзя вызывать одновременно из нескольких потоков.
+    \param d Диспетчер.
+    \param batch Пакет данных.
+    \param out Результаты [batch->n]: 0 - аномалий не найдено.
+    \return Количество элементов с аномалиями или 0, если голосовать
+        некому (out при этом заполняется нулями).
+*/
+IAM_API size_t iam_dispatcher_run(iam_dispatcher_t *d,
+    const iam_batch_t *batch, uint8_t *out);
+
+#endif
\ No newline at end of file
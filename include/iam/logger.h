@@ -10,6 +10,8 @@
 #define __IAM_LOGGER_H__
 
 #include "iam/iam.h"
+#include <stdint.h>
+#include <stdbool.h>
 #include <time.h>
 
 /*! Определение уровней логирования.
@@ -29,10 +31,40 @@ typedef struct {
     time_t time;    
     iam_logger_level level;
     const char *msg;
+    uint64_t ns;    //!< Монотонное время в наносекундах для упорядочивания.
 } iam_log_t;
 
 typedef void (*iam_log_save_fn)(iam_log_t *log);
 
+/*! Сообщение в двоичном виде: строка формата и значения аргументов.
+    Текст получается функцией iam_logger_format_bin, в том числе позже
+    и в другом процессе, если сохранена строка формата.
+*/
+typedef struct {
+    iam_id_t id;
+    time_t time;
+    uint64_t ns;        //!< Монотонное время в наносекундах.
+    iam_logger_level level;
+    const char *fmt;    //!< Строка формата, переданная iam_logger_putb.
+    const void *args;   //!< Значения аргументов.
+    size_t size;        //!< Размер args в байтах.
+} iam_log_bin_t;
+
+typedef void (*iam_log_save_bin_fn)(const iam_log_bin_t *log);
+
+/*! Состояние ограничителя частоты сообщений одного места вызова.
+    Объявляется статическим или в памяти, не освобождаемой до iam_exit,
+    с нулевой инициализацией.
+*/
+typedef struct iam_log_limit_s {
+    uint64_t tat;       //!< Время, до которого исчерпан запас сообщений, нс.
+    uint64_t skipped;   //!< Сообщений, пропущенных с последнего вывода.
+    uint64_t is_listed; //!< Место вызова в списке для вывода при iam_exit.
+    iam_id_t id;        //!< Модуль и уровень пропущенных сообщений.
+    iam_logger_level level;
+    struct iam_log_limit_s *next;
+} iam_log_limit_t;
+
 #ifndef IAM_LOG_LEVELS
     #ifdef IAM_RELEASE
         #define IAM_LOG_LEVELS ~(IAM_TRACE | IAM_DEBUG)
@@ -59,6 +91,56 @@ IAM_API void iam_logger_puts(iam_id_t id, iam_logger_level level,
 IAM_API void iam_logger_putf(iam_id_t id, iam_logger_level level,
     const char *msg, ...);
 
+/*! Вывод сообщения в лог с отложенным форматированием.
+    Вызывающий поток только копирует значения аргументов; текст
+    формируется, когда сообщение получает текстовое хранилище (в фоновом
+    потоке, если включена настройка log_async). Строка формата должна
+    существовать до завершения работы libIAM (обычно это литерал).
+    Поддерживаются преобразования printf, кроме %n; строки %s копируются.
+    \param id Идентификатор модуля.
+    \param level  Уровень сообщения.
+    \param fmt    Строка формата printf.
+*/
+IAM_API void iam_logger_putb(iam_id_t id, iam_logger_level level,
+    const char *fmt, ...);
+
+/*! Проверяет, нужно ли сообщение уровня level хоть одному хранилищу.
+    Позволяет не готовить аргументы сообщения, которое будет отброшено.
+    \param level Уровень сообщения.
+    \return true - сообщение будет сохранено.
+*/
+IAM_API bool iam_logger_is_on(iam_logger_level level);
+
+/*! Ограничивает частоту сообщений одного места вызова настройками
+    log_rate (сообщений в секунду) и log_burst (сообщений подряд). Перед
+    первым разрешённым сообщением после пропусков выводится количество
+    пропущенных; пропуски, после которых сообщений не было, выводятся при
+    iam_exit.
+    \param id Идентификатор модуля.
+    \param level Уровень сообщения.
+    \param limit Состояние ограничителя места вызова.
+    \return true - сообщение нужно вывести.
+*/
+IAM_API bool iam_logger_limit(iam_id_t id, iam_logger_level level,
+    iam_log_limit_t *limit);
+
+/*! Формирует текст двоичного сообщения.
+    \param buf Буфер для текста.
+    \param size Размер буфера.
+    \param log Двоичное сообщение.
+    \return Длина текста без завершающего нуля (не больше size - 1).
+*/
+IAM_API size_t iam_logger_format_bin(char *buf, size_t size,
+    const iam_log_bin_t *log);
+
+/*! Возвращает время в виде "ДД.ММ.ГГГГ чч:мм:сс". Строка хранится
+    отдельно для каждого потока и формируется заново только при смене
+    секунды, поэтому вызов для каждого сообщения почти ничего не стоит.
+    \param time Время сообщения.
+    \return Строка, действительная до следующего вызова в этом потоке.
+*/
+IAM_API const char *iam_logger_time_str(time_t time);
+
 /*! Регистрирует функцию для сохранения лога.
     \param id Идентификатор модуля.
     \param filter Фильтр уровней сообщения.
@@ -69,6 +151,45 @@ IAM_API void iam_logger_putf(iam_id_t id, iam_logger_level level,
 IAM_API int iam_logger_reg_save(iam_id_t id, iam_logger_level filter,
     iam_log_save_fn save);
 
+/*! Регистрирует функцию для сохранения лога в двоичном виде. Она получает
+    и текстовые сообщения: как формат "%s" с одним аргументом.
+    \param id Идентификатор модуля.
+    \param filter Фильтр уровней сообщения.
+    \param save Функция сохранения.
+    \return 0 - успешно, иначе не хватило памяти:
+            1 - для структуры данных, 2 - для добавления в список
+*/
+IAM_API int iam_logger_reg_save_bin(iam_id_t id, iam_logger_level filter,
+    iam_log_save_bin_fn save);
+
+/*! true - сообщения уровня level остаются в сборке (см. IAM_LOG_LEVELS).
+*/
+#define IAM_LOG_IS_BUILT(level) (((level) & (IAM_LOG_LEVELS)) != 0)
+
+/*! Вызовы iam_logger_puts, iam_logger_putf и iam_logger_putb, которые
+    удаляются при компиляции вместе с вычислением аргументов, если уровень
+    не входит в IAM_LOG_LEVELS (с IAM_RELEASE - TRACE и DEBUG).
+*/
+#define IAM_LOG_PUTS(id, level, msg) do { \
+    if (IAM_LOG_IS_BUILT(level)) iam_logger_puts(id, level, msg); \
+} while (0)
+#define IAM_LOG_PUTF(id, level, ...) do { \
+    if (IAM_LOG_IS_BUILT(level)) iam_logger_putf(id, level, __VA_ARGS__); \
+} while (0)
+#define IAM_LOG_PUTB(id, level, ...) do { \
+    if (IAM_LOG_IS_BUILT(level)) iam_logger_putb(id, level, __VA_ARGS__); \
+} while (0)
+
+/*! Вызов iam_logger_putf с ограничением частоты для этого места вызова
+    (см. iam_logger_limit); аргументы пропущенных сообщений не вычисляются.
+*/
+#define IAM_LOG_PUTF_LIMIT(id, level, ...) do { \
+    static iam_log_limit_t iam__log_limit; \
+    if (IAM_LOG_IS_BUILT(level) \
+            && iam_logger_limit(id, level, &iam__log_limit)) \
+        iam_logger_putf(id, level, __VA_ARGS__); \
+} while (0)
+
 #define IAM_LOG_ERR(f, ...) \
     iam_logger_putf(IAM_ID_NAME, IAM_ERROR, f, __VA_ARGS__);
 
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+/*! \file iam/ring.h
+    \brief Кольцевой буфер для передачи данных алгоритмам.
+
+    Ограниченная очередь без блокировок между потоками захвата данных и
+    потоком анализа. Элементы имеют одинаковый размер и хранятся подряд,
+    поэтому непрерывная часть буфера передаётся алгоритму без копирования:
+
+        const double *x = iam_ring_peek(ring, max, &n);
+        iam_real_inst_analyze_batch(inst, x, n, k, out);
+        iam_ring_release(ring, n);
+
+    Пакеты переменной длины передаются бинарным алгоритмам элементами
+    фиксированного размера с указателем и длиной.
+*/
+#ifndef __IAM_RING_H__
+#define __IAM_RING_H__
+
+#include "iam.h"
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*! Режим доступа к буферу.
+*/
+typedef enum {
+    IAM_RING_SPSC,  //!< Один поток записи, один поток чтения.
+    IAM_RING_MPSC   //!< Несколько потоков записи, один поток чтения.
+} iam_ring_mode_t;
+
+/*! Счётчики буфера.
+*/
+typedef struct {
+    uint64_t pushed;    //!< Записано элементов.
+    uint64_t popped;    //!< Прочитано элементов.
+    uint64_t dropped;   //!< Не записано из-за переполнения.
+    uint64_t peak;      //!< Наибольшее заполнение, замеченное при чтении.
+} iam_ring_stats_t;
+
+typedef struct iam_ring_s iam_ring_t;
+
+/*! Создаёт буфер.
+    \param capacity Количество элементов, округляется до степени двойки.
+    \param item_size Размер элемента в байтах.
+    \param mode Режим доступа.
+    \return Буфер или NULL при нехватке памяти или нулевых размерах.
+*/
+IAM_API iam_ring_t *iam_ring_create(size_t capacity, size_t item_size,
+    iam_ring_mode_t mode);
+
+/*! Уничтожает буфер.
+    \param r Буфер (NULL игнорируется).
+*/
+IAM_API void iam_ring_destroy(iam_ring_t *r);
+
+/*! Записывает элементы в буфер, не ожидая освобождения места.
+    Элементы, для которых места не хватило, не записываются и учитываются
+    в счётчике dropped; вызывающий может повторить их запись позже.
+    \param r Буфер.
+    \param items Элементы [n X item_size].
+    \param n Количество элементов.
+    \return Количество записанных элементов (первые из items).
+*/
+IAM_API size_t iam_ring_push(iam_ring_t *r, const void *items, size_t n);
+
+/*! Возвращает непрерывную часть записанных элементов без копирования.
+    Элементы остаются в буфере до вызова iam_ring_release.
+    Вызывается только из потока чтения.
+    \param r Буфер.
+    \param max Наибольшее количество элементов.
+    \param n Количество доступных элементов (0 - буфер пуст).
+    \return Первый элемент или NULL, если буфер пуст.
+*/
+IAM_API const void *iam_ring_peek(iam_ring_t *r, size_t max, size_t *n);
+
+/*! Освобождает первые элементы, полученные iam_ring_peek.
+    \param r Буфер.
+    \param n Количество элементов, не больше полученного.
+*/
+IAM_API void iam_ring_release(iam_ring_t *r, size_t n);
+
+/*! Копирует записанные элементы и освобождает их.
+    Вызывается только из потока чтения.
+    \param r Буфер.
+    \param items Приёмник [max X item_size].
+    \param max Наибольшее количество элементов.
+    \return Количество прочитанных элементов.
+*/
+IAM_API size_t iam_ring_pop(iam_ring_t *r, void *items, size_t max);
+
+/*! Возвращает количество элементов в буфере (заполнение).
+    \param r Буфер.
+    \return Количество записанных, но не освобождённых элементов.
+*/
+IAM_API size_t iam_ring_count(iam_ring_t *r);
+
+/*! Возвращает счётчики буфера.
+    \param r Буфер.
+    \param stats Счётчики.
+*/
+IAM_API void iam_ring_stats(iam_ring_t *r, iam_ring_stats_t *stats);
+
+#endif
\ No newline at end of file
@@ -42,6 +42,15 @@ IAM_API void iam_setting_rewind(iam_id_t id);
 */
 IAM_API iam_setting_t *iam_setting_read(iam_id_t id);
 
+/*! Ищет пункт настройки по имени без перебора списка.
+    Указатель остаётся действительным до вызова iam_exit, поэтому его
+    можно получить один раз и использовать для частой смены значения.
+    \param id Идентификатор модуля.
+    \param name Имя пункта настройки.
+    \return Пункт настройки или NULL, если он не зарегистрирован.
+*/
+IAM_API iam_setting_t *iam_setting_find(iam_id_t id, const char *name);
+
 /*! Регистрирует функцию обратного вызова после обновления настроек.
     \param id Идентификатор модуля.
     \param fn Функция обратного вызова.
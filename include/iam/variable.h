@@ -11,6 +11,7 @@
 #define __IAM_VARIABLE_H__
 
 #include "iam.h"
+#include "iam/logger.h"
 #include <memory.h>
 #include <stdio.h>
 #include <stdint.h>
@@ -137,6 +138,7 @@ typedef struct {
             };
         } num;
     };
+    iam_log_limit_t limit;  //!< Частота предупреждений о значениях.
 } iam_variable_t;
 
 /*! Сбрасывает переменные, связанные с последней операцией над переменной.
@@ -0,0 +1,74 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+/*! \file iam/worker.h
+    \brief Пул рабочих потоков libIAM.
+
+    Позволяет плагинам распределять независимые части вычислений между
+    потоками libIAM. Размер пула задаётся настройкой "threads" модуля libIAM.
+    Кроме того, libIAM выполняет асинхронные задания в отдельных потоках
+    (настройка "job_threads"), не блокируя вызывающий поток.
+*/
+#ifndef __IAM_WORKER_H__
+#define __IAM_WORKER_H__
+
+#include "iam.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+/*! Функция для обработки одной части задачи.
+    \param ctx Контекст задачи.
+    \param i Номер части [0; count).
+*/
+typedef void (*iam_task_fn)(void *ctx, size_t i);
+
+/*! Возвращает количество потоков, включая вызывающий.
+    \return Количество потоков (не меньше 1).
+*/
+IAM_API size_t iam_worker_count(void);
+
+/*! Выполняет части задачи в потоках libIAM и ожидает их завершения.
+    Каждая часть выполняется ровно один раз, порядок не определён.
+    Вызов из обработчика части выполняется последовательно.
+    \param count Количество частей.
+    \param fn Функция обработки части.
+    \param ctx Контекст задачи.
+*/
+IAM_API void iam_worker_run(size_t count, iam_task_fn fn, void *ctx);
+
+/*! Функция асинхронного задания.
+    \param ctx Контекст задания.
+*/
+typedef void (*iam_job_fn)(void *ctx);
+
+//! Асинхронное задание.
+typedef struct iam_job_s iam_job_t;
+
+/*! Ставит задание в очередь потоков заданий и сразу возвращает управление.
+    Задания выполняются в порядке постановки; внутри задания можно
+    вызывать iam_worker_run. Если потоков заданий нет (job_threads = 0),
+    задание выполняется сразу в вызывающем потоке.
+    \param fn Функция задания.
+    \param ctx Контекст задания, действительный до его завершения.
+    \return Задание, которое нужно освободить iam_job_free, или NULL
+        при нехватке памяти.
+*/
+IAM_API iam_job_t *iam_job_submit(iam_job_fn fn, void *ctx);
+
+/*! Проверяет, завершено ли задание, без ожидания.
+    \param job Задание.
+    \return true - задание выполнено.
+*/
+IAM_API bool iam_job_is_done(iam_job_t *job);
+
+/*! Ожидает завершения задания.
+    \param job Задание (NULL игнорируется).
+*/
+IAM_API void iam_job_wait(iam_job_t *job);
+
+/*! Ожидает завершения задания и освобождает его.
+    \param job Задание (NULL игнорируется).
+*/
+IAM_API void iam_job_free(iam_job_t *job);
+
+#endif
\ No newline at end of file
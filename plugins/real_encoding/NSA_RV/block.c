@@ -0,0 +1,118 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include "block.h"
+#include "distance.h"
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+// Оценка погрешности |x|² + |c|² - 2x·c относительно |x|² + |c|²
+#define RV_BLOCK_EPS(n) (((n) + 4) * 4 * DBL_EPSILON)
+
+// Измерения обрабатываются частями; после каждой части строка
+// пропускается, если частичные расстояния уже больше радиусов
+#define RV_PART 16
+#define PART_N(dim) (((dim) + RV_PART - 1) / RV_PART)
+
+int rv_rows_init(rv_rows_t *m, const double *x, size_t stride, size_t dim,
+    const size_t *ids, size_t n) {
+    size_t i, j, part_n = PART_N(dim);
+    const double *p;
+    double *norm2;
+    m->row_n = n;
+    m->dim = dim;
+    m->rows = (double *)malloc(sizeof(double) * (n * dim + 1));
+    m->norm2 = (double *)calloc(n * part_n + 1, sizeof(double));
+    if (m->rows == NULL || m->norm2 == NULL) {
+        rv_rows_free(m);
+        return 1;
+    }
+    for (i = 0; i < n; i++) {
+        p = x + ids[i] * stride;
+        memcpy(m->rows + i * dim, p, sizeof(double) * dim);
+        norm2 = m->norm2 + i * part_n;
+        for (j = 0; j < dim; j++)
+            norm2[j / RV_PART] += p[j] * p[j];
+    }
+    return 0;
+}
+
+void rv_rows_free(rv_rows_t *m) {
+    free(m->rows);
+    free(m->norm2);
+    m->rows = m->norm2 = NULL;
+    m->row_n = 0;
+}
+
+// Проверяет до RV_LANES кандидатов, пока каждый не найдёт строку
+static void censor_lanes(const rv_rows_t *m, const double *cand, size_t n,
+    const double *radii, bool *hit, double *bt, double *cn2) {
+    size_t dim = m->dim, part_n = PART_N(dim), i, j, b, c, len, pending = 0;
+    double r2[RV_LANES], dot[RV_LANES], d2[RV_LANES], eps[RV_LANES], v;
+    const double *x, *xn2;
+    bool is_near, done[RV_LANES];
+    for (c = 0; c < part_n * RV_LANES; c++)
+        cn2[c] = 0;
+    for (b = 0; b < RV_LANES; b++) {
+        for (j = 0; j < dim; j++) {
+            v = b < n ? cand[b * dim + j] : 0;
+            bt[j * RV_LANES + b] = v;
+            cn2[j / RV_PART * RV_LANES + b] += v * v;
+        }
+        if (b < n) {
+            r2[b] = radii[b] * radii[b];
+            // Отрицательный радиус не накрывает ни одной строки
+            hit[b] = false;
+            done[b] = radii[b] < 0;
+            pending += !done[b];
+        }
+    }
+    for (i = 0; i < m->row_n && pending > 0; i++) {
+        x = m->rows + i * dim;
+        xn2 = m->norm2 + i * part_n;
+        for (b = 0; b < n; b++)
+            d2[b] = eps[b] = 0;
+        for (c = 0, j = 0; c < part_n; c++, j += len) {
+            len = dim - j < RV_PART ? dim - j : RV_PART;
+            rv_dot(bt + j * RV_LANES, x + j, len, dot);
+            is_near = false;
+            for (b = 0; b < n; b++) {
+                v = xn2[c] + cn2[c * RV_LANES + b];
+                d2[b] += v - 2 * dot[b];
+                eps[b] += v * RV_BLOCK_EPS(len);
+                is_near |= !done[b] && d2[b] <= r2[b] + eps[b];
+            }
+            // Частичная сумма не больше полной: строка дальше всех радиусов
+            if (!is_near)
+                break;
+        }
+        if (c < part_n)
+            continue;
+        for (b = 0; b < n; b++) {
+            if (done[b] || d2[b] > r2[b] + eps[b])
+                continue;
+            if (d2[b] < r2[b] - eps[b]
+                || rv_is_within(cand + b * dim, x, dim, radii[b])) {
+                hit[b] = done[b] = true;
+                pending--;
+            }
+        }
+    }
+}
+
+int rv_block_censor(const rv_rows_t *m, const double *cand, size_t cand_n,
+    const double *radii, bool *hit) {
+    size_t g, n, part_n = PART_N(m->dim);
+    double *bt = (double *)malloc(sizeof(double)
+        * RV_LANES * (m->dim + part_n + 1));
+    if (bt == NULL)
+        return 1;
+    for (g = 0; g < cand_n; g += RV_LANES) {
+        n = cand_n - g < RV_LANES ? cand_n - g : RV_LANES;
+        censor_lanes(m, cand + g * m->dim, n, radii + g, hit + g, bt,
+            bt + RV_LANES * m->dim);
+    }
+    free(bt);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __NSA_RV_BLOCK_H__
+#define __NSA_RV_BLOCK_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*! Строки, упакованные подряд для блочного вычисления расстояний.
+*/
+typedef struct {
+    double *rows;       // [row_n X dim]
+    double *norm2;      // Квадраты норм строк
+    size_t row_n;
+    size_t dim;
+} rv_rows_t;
+
+/*! Копирует строки x с номерами ids и считает их нормы.
+    \param x Матрица [.. X stride].
+    \return 0 - успешно, 1 - нехватка памяти.
+*/
+int rv_rows_init(rv_rows_t *m, const double *x, size_t stride, size_t dim,
+    const size_t *ids, size_t n);
+
+void rv_rows_free(rv_rows_t *m);
+
+/*! Проверяет блок кандидатов: hit[b] = true, если хотя бы одна строка m
+    не дальше radii[b] от кандидата b (как rv_is_within).
+    Расстояния считаются через |x|² + |c|² - 2x·c сразу для RV_LANES
+    кандидатов, пары около границы проверяются точно.
+    \param cand Кандидаты [cand_n X m->dim].
+    \return 0 - успешно, 1 - нехватка памяти.
+*/
+int rv_block_censor(const rv_rows_t *m, const double *cand, size_t cand_n,
+    const double *radii, bool *hit);
+
+#endif
\ No newline at end of file
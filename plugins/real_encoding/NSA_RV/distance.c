@@ -0,0 +1,296 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include "distance.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) \
+    || defined(_M_IX86)
+    #define RV_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define RV_TARGET(isa) /* empty */
+    #else
+        #include <cpuid.h>
+        #define RV_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+static double sqdist_scalar(const double *a, const double *b, size_t n) {
+    double s0 = 0, s1 = 0, d0, d1;
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2) {
+        d0 = a[j] - b[j];
+        d1 = a[j + 1] - b[j + 1];
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+    }
+    if (j < n) {
+        d0 = a[j] - b[j];
+        s0 += d0 * d0;
+    }
+    return s0 + s1;
+}
+
+// Размер части вектора, после которой проверяется частичная сумма
+#define RV_CHUNK 16
+
+// Ядро с досрочным выходом на основе ядра kernel
+#define RV_WITHIN(name, kernel)                                         \
+static double name(const double *a, const double *b, size_t n,          \
+    double limit) {                                                     \
+    double s = 0;                                                       \
+    size_t j;                                                           \
+    for (j = 0; j + RV_CHUNK < n; j += RV_CHUNK) {                      \
+        s += kernel(a + j, b + j, RV_CHUNK);                            \
+        if (s > limit)                                                  \
+            return s;                                                   \
+    }                                                                   \
+    return s + kernel(a + j, b + j, n - j);                             \
+}
+
+RV_WITHIN(within_scalar, sqdist_scalar)
+
+static void dot_scalar(const double *bt, const double *x, size_t n,
+    double *out) {
+    double acc[RV_LANES] = { 0 };
+    size_t j, b;
+    for (j = 0; j < n; j++, bt += RV_LANES)
+        for (b = 0; b < RV_LANES; b++)
+            acc[b] += x[j] * bt[b];
+    for (b = 0; b < RV_LANES; b++)
+        out[b] = acc[b];
+}
+
+rv_sqdist_fn rv_sqdist = sqdist_scalar;
+rv_sqdist_within_fn rv_sqdist_within = within_scalar;
+rv_dot_fn rv_dot = dot_scalar;
+
+#ifdef RV_X86
+
+RV_TARGET("sse2")
+static double sqdist_sse2(const double *a, const double *b, size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), d0, d1;
+    double s;
+    size_t j;
+    for (j = 0; n - j >= 4; j += 4) {
+        d0 = _mm_sub_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j));
+        d1 = _mm_sub_pd(_mm_loadu_pd(a + j + 2), _mm_loadu_pd(b + j + 2));
+        s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+    }
+    s0 = _mm_add_pd(s0, s1);
+    s0 = _mm_add_sd(s0, _mm_unpackhi_pd(s0, s0));
+    s = _mm_cvtsd_f64(s0);
+    for (; j < n; j++)
+        s += (a[j] - b[j]) * (a[j] - b[j]);
+    return s;
+}
+
+RV_TARGET("avx2")
+static double sqdist_avx2(const double *a, const double *b, size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), d0, d1;
+    __m128d h;
+    double s;
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8) {
+        d0 = _mm256_sub_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j));
+        d1 = _mm256_sub_pd(_mm256_loadu_pd(a + j + 4),
+            _mm256_loadu_pd(b + j + 4));
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(d0, d0));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(d1, d1));
+    }
+    if (j + 4 <= n) {
+        d0 = _mm256_sub_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j));
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(d0, d0));
+        j += 4;
+    }
+    s0 = _mm256_add_pd(s0, s1);
+    h = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+    h = _mm_add_sd(h, _mm_unpackhi_pd(h, h));
+    s = _mm_cvtsd_f64(h);
+    for (; j < n; j++)
+        s += (a[j] - b[j]) * (a[j] - b[j]);
+    return s;
+}
+
+RV_TARGET("avx512f")
+static double sqdist_avx512(const double *a, const double *b, size_t n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), d0, d1;
+    __mmask8 m;
+    size_t j;
+    for (j = 0; j + 16 <= n; j += 16) {
+        d0 = _mm512_sub_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j));
+        d1 = _mm512_sub_pd(_mm512_loadu_pd(a + j + 8),
+            _mm512_loadu_pd(b + j + 8));
+        s0 = _mm512_add_pd(s0, _mm512_mul_pd(d0, d0));
+        s1 = _mm512_add_pd(s1, _mm512_mul_pd(d1, d1));
+    }
+    for (; j < n; j += 8) {
+        // Хвост вектора дочитывается по маске без выхода за границы
+        m = n - j >= 8 ? 0xFF : (__mmask8)((1u << (n - j)) - 1);
+        d0 = _mm512_sub_pd(_mm512_maskz_loadu_pd(m, a + j),
+            _mm512_maskz_loadu_pd(m, b + j));
+        s0 = _mm512_add_pd(s0, _mm512_mul_pd(d0, d0));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+RV_TARGET("sse2") RV_WITHIN(within_sse2, sqdist_sse2)
+RV_TARGET("avx2") RV_WITHIN(within_avx2, sqdist_avx2)
+RV_TARGET("avx512f") RV_WITHIN(within_avx512, sqdist_avx512)
+
+RV_TARGET("sse2")
+static void dot_sse2(const double *bt, const double *x, size_t n,
+    double *out) {
+    __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd();
+    __m128d a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd(), v;
+    size_t j;
+    for (j = 0; j < n; j++, bt += RV_LANES) {
+        v = _mm_set1_pd(x[j]);
+        a0 = _mm_add_pd(a0, _mm_mul_pd(v, _mm_loadu_pd(bt)));
+        a1 = _mm_add_pd(a1, _mm_mul_pd(v, _mm_loadu_pd(bt + 2)));
+        a2 = _mm_add_pd(a2, _mm_mul_pd(v, _mm_loadu_pd(bt + 4)));
+        a3 = _mm_add_pd(a3, _mm_mul_pd(v, _mm_loadu_pd(bt + 6)));
+    }
+    _mm_storeu_pd(out, a0);
+    _mm_storeu_pd(out + 2, a1);
+    _mm_storeu_pd(out + 4, a2);
+    _mm_storeu_pd(out + 6, a3);
+}
+
+RV_TARGET("avx2")
+static void dot_avx2(const double *bt, const double *x, size_t n,
+    double *out) {
+    // Чётные и нечётные измерения в разных регистрах скрывают задержку
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+    __m256d b0 = _mm256_setzero_pd(), b1 = _mm256_setzero_pd(), v;
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2, bt += 2 * RV_LANES) {
+        v = _mm256_set1_pd(x[j]);
+        a0 = _mm256_add_pd(a0, _mm256_mul_pd(v, _mm256_loadu_pd(bt)));
+        a1 = _mm256_add_pd(a1, _mm256_mul_pd(v, _mm256_loadu_pd(bt + 4)));
+        v = _mm256_set1_pd(x[j + 1]);
+        b0 = _mm256_add_pd(b0, _mm256_mul_pd(v, _mm256_loadu_pd(bt + 8)));
+        b1 = _mm256_add_pd(b1, _mm256_mul_pd(v, _mm256_loadu_pd(bt + 12)));
+    }
+    if (j < n) {
+        v = _mm256_set1_pd(x[j]);
+        a0 = _mm256_add_pd(a0, _mm256_mul_pd(v, _mm256_loadu_pd(bt)));
+        a1 = _mm256_add_pd(a1, _mm256_mul_pd(v, _mm256_loadu_pd(bt + 4)));
+    }
+    _mm256_storeu_pd(out, _mm256_add_pd(a0, b0));
+    _mm256_storeu_pd(out + 4, _mm256_add_pd(a1, b1));
+}
+
+RV_TARGET("avx512f")
+static void dot_avx512(const double *bt, const double *x, size_t n,
+    double *out) {
+    __m512d a0 = _mm512_setzero_pd(), a1 = _mm512_setzero_pd();
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2, bt += 2 * RV_LANES) {
+        a0 = _mm512_add_pd(a0, _mm512_mul_pd(_mm512_set1_pd(x[j]),
+            _mm512_loadu_pd(bt)));
+        a1 = _mm512_add_pd(a1, _mm512_mul_pd(_mm512_set1_pd(x[j + 1]),
+            _mm512_loadu_pd(bt + 8)));
+    }
+    if (j < n)
+        a0 = _mm512_add_pd(a0, _mm512_mul_pd(_mm512_set1_pd(x[j]),
+            _mm512_loadu_pd(bt)));
+    _mm512_storeu_pd(out, _mm512_add_pd(a0, a1));
+}
+
+static void cpuid(unsigned leaf, unsigned sub, unsigned r[4]) {
+#ifdef _MSC_VER
+    __cpuidex((int *)r, (int)leaf, (int)sub);
+#else
+    if (!__get_cpuid_count(leaf, sub, &r[0], &r[1], &r[2], &r[3]))
+        r[0] = r[1] = r[2] = r[3] = 0;
+#endif
+}
+
+// Регистры, состояние которых сохраняет ОС (XCR0)
+static unsigned long long xgetbv(void) {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+static rv_simd_t detect(void) {
+    unsigned r[4], max_leaf;
+    unsigned long long xcr0 = 0;
+    rv_simd_t best = RV_SIMD_SCALAR;
+    cpuid(0, 0, r);
+    max_leaf = r[0];
+    if (max_leaf < 1)
+        return best;
+    cpuid(1, 0, r);
+    if (r[3] & (1u << 26))
+        best = RV_SIMD_SSE2;
+    // OSXSAVE и AVX
+    if (!(r[2] & (1u << 27)) || !(r[2] & (1u << 28)) || max_leaf < 7)
+        return best;
+    xcr0 = xgetbv();
+    if ((xcr0 & 0x6) != 0x6)
+        return best;
+    cpuid(7, 0, r);
+    if (r[1] & (1u << 5))
+        best = RV_SIMD_AVX2;
+    // AVX-512F и сохранение регистров opmask/ZMM
+    if ((r[1] & (1u << 16)) && (xcr0 & 0xE6) == 0xE6)
+        best = RV_SIMD_AVX512;
+    return best;
+}
+
+#else
+
+static rv_simd_t detect(void) {
+    return RV_SIMD_SCALAR;
+}
+
+#endif
+
+rv_simd_t rv_distance_init(rv_simd_t simd) {
+    rv_simd_t best = detect();
+    if (simd > best)
+        simd = best;
+    switch (simd) {
+#ifdef RV_X86
+        case RV_SIMD_AVX512:
+            rv_sqdist = sqdist_avx512;
+            rv_sqdist_within = within_avx512;
+            rv_dot = dot_avx512;
+            break;
+        case RV_SIMD_AVX2:
+            rv_sqdist = sqdist_avx2;
+            rv_sqdist_within = within_avx2;
+            rv_dot = dot_avx2;
+            break;
+        case RV_SIMD_SSE2:
+            rv_sqdist = sqdist_sse2;
+            rv_sqdist_within = within_sse2;
+            rv_dot = dot_sse2;
+            break;
+#endif
+        default:
+            simd = RV_SIMD_SCALAR;
+            rv_sqdist = sqdist_scalar;
+            rv_sqdist_within = within_scalar;
+            rv_dot = dot_scalar;
+    }
+    return simd;
+}
+
+const char *rv_distance_name(rv_simd_t simd) {
+    switch (simd) {
+        case RV_SIMD_SCALAR: return "scalar";
+        case RV_SIMD_SSE2:   return "sse2";
+        case RV_SIMD_AVX2:   return "avx2";
+        case RV_SIMD_AVX512: return "avx512";
+        default:             return "auto";
+    }
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __NSA_RV_DISTANCE_H__
+#define __NSA_RV_DISTANCE_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+
+/*! Реализации ядра вычисления расстояния.
+*/
+typedef enum {
+    RV_SIMD_SCALAR,
+    RV_SIMD_SSE2,
+    RV_SIMD_AVX2,
+    RV_SIMD_AVX512,
+    RV_SIMD_AUTO
+} rv_simd_t;
+
+/*! Квадрат евклидова расстояния между векторами a и b длины n.
+*/
+typedef double (*rv_sqdist_fn)(const double *a, const double *b, size_t n);
+
+extern rv_sqdist_fn rv_sqdist;
+
+/*! Квадрат расстояния с досрочным выходом: суммирование прекращается,
+    как только частичная сумма превысит limit.
+    \return Полная сумма или частичная сумма больше limit.
+*/
+typedef double (*rv_sqdist_within_fn)(const double *a, const double *b,
+    size_t n, double limit);
+
+extern rv_sqdist_within_fn rv_sqdist_within;
+
+/*! Количество векторов в блоке rv_dot.
+*/
+#define RV_LANES 8
+
+/*! Скалярные произведения x на RV_LANES векторов длины n, упакованных
+    по измерениям: bt[j * RV_LANES + b] - измерение j вектора b.
+*/
+typedef void (*rv_dot_fn)(const double *bt, const double *x, size_t n,
+    double *out);
+
+extern rv_dot_fn rv_dot;
+
+/*! Относительная ширина полосы вокруг radius², в которой порядок
+    суммирования SIMD-ядра может повлиять на результат сравнения.
+*/
+#define RV_BAND 1E-10
+
+/*! Выбирает ядро по инструкциям, доступным процессору (cpuid).
+    \param simd Требуемая реализация, RV_SIMD_AUTO - лучшая из доступных.
+    \return Выбранная реализация (не выше поддерживаемой процессором).
+*/
+rv_simd_t rv_distance_init(rv_simd_t simd);
+
+/*! Название реализации для вывода в лог.
+*/
+const char *rv_distance_name(rv_simd_t simd);
+
+/*! Эталонное расстояние в порядке суммирования исходного алгоритма.
+*/
+static inline double rv_dist_ref(const double *a, const double *b, size_t n) {
+    double euclidean = 0;
+    size_t j;
+    for (j = 0; j < n; j++)
+        euclidean += pow(a[j] - b[j], 2);
+    return sqrt(euclidean);
+}
+
+/*! Евклидова норма вектора.
+*/
+static inline double rv_norm(const double *a, size_t n) {
+    double s = 0;
+    size_t j;
+    for (j = 0; j < n; j++)
+        s += a[j] * a[j];
+    return sqrt(s);
+}
+
+/*! Проверяет попадание вектора x в детектор d (расстояние < radius).
+    Результат совпадает с rv_dist_ref(d, x, n) < radius: вблизи границы
+    сравнение повторяется эталонным способом. Суммирование прекращается,
+    когда частичная сумма уже вышла за полосу вокруг radius².
+*/
+static inline bool rv_is_inside(const double *d, const double *x, size_t n,
+    double radius) {
+    double r2 = radius * radius, d2;
+    if (!(radius > 0))
+        return false;
+    d2 = rv_sqdist_within(d, x, n, r2 + r2 * RV_BAND);
+    if (fabs(d2 - r2) > r2 * RV_BAND)
+        return d2 < r2;
+    return rv_dist_ref(d, x, n) < radius;
+}
+
+/*! Проверяет, что вектор x не дальше radius от d (расстояние <= radius).
+    Результат совпадает с rv_dist_ref(d, x, n) <= radius.
+*/
+static inline bool rv_is_within(const double *d, const double *x, size_t n,
+    double radius) {
+    double r2 = radius * radius, d2;
+    if (radius < 0)
+        return false;
+    d2 = rv_sqdist_within(d, x, n, r2 + r2 * RV_BAND);
+    if (fabs(d2 - r2) > r2 * RV_BAND)
+        return d2 < r2;
+    return rv_dist_ref(d, x, n) <= radius;
+}
+
+/*! Нижняя граница расстояния по нормам (неравенство треугольника):
+    true - |norm_d - norm_x| >= radius, вектор заведомо вне детектора.
+    Запас RV_BAND покрывает погрешность вычисления норм.
+*/
+static inline bool rv_is_far(double norm_d, double norm_x, double radius) {
+    return fabs(norm_d - norm_x) - radius > (norm_d + norm_x) * RV_BAND;
+}
+
+#endif
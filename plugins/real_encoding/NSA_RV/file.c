@@ -0,0 +1,167 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include "file.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#define ALIGN(size) \
+    (((size) + RV_FILE_ALIGN - 1) / RV_FILE_ALIGN * RV_FILE_ALIGN)
+
+// Размеры разделов набора в порядке их размещения
+static void section_sizes(const rv_file_header_t *h, uint64_t size[6]) {
+    size[0] = ALIGN(h->det_n * h->det_stride * sizeof(double));
+    size[1] = ALIGN(h->det_n * sizeof(double));
+    size[2] = ALIGN(h->det_n * sizeof(double));
+    size[3] = ALIGN((h->det_n + 63) / 64 * sizeof(uint64_t));
+    size[4] = ALIGN(h->det_n * sizeof(uint64_t));
+    size[5] = ALIGN(h->det_n * sizeof(uint64_t));
+}
+
+void rv_file_header_init(rv_file_header_t *h, uint64_t attr_n,
+    uint64_t det_n, uint64_t det_stride, uint64_t set_n, bool is_variable,
+    double det_r) {
+    uint64_t size[6];
+    size_t i;
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, RV_FILE_MAGIC, sizeof(h->magic));
+    h->version = RV_FILE_VERSION;
+    h->flags = is_variable ? RV_FILE_VARIABLE : 0;
+    h->attr_n = attr_n;
+    h->det_n = det_n;
+    h->det_stride = det_stride;
+    h->set_n = set_n;
+    h->det_r = det_r;
+    section_sizes(h, size);
+    for (i = 0; i < 6; i++)
+        h->set_size += size[i];
+}
+
+void rv_set_bind(rv_set_t *s, const rv_file_header_t *h, void *base,
+    size_t q) {
+    uint64_t size[6];
+    char *p = (char *)base + q * h->set_size;
+    section_sizes(h, size);
+    s->centers = (double *)p;
+    p += size[0];
+    s->radii = (double *)p;
+    p += size[1];
+    s->norms = (double *)p;
+    p += size[2];
+    s->valid = (uint64_t *)p;
+    p += size[3];
+    s->count_f = (uint64_t *)p;
+    p += size[4];
+    s->count_p = (uint64_t *)p;
+}
+
+// Проверяет заголовок файла размером size
+static bool is_header_valid(const rv_file_header_t *h, uint64_t size) {
+    rv_file_header_t e;
+    if (memcmp(h->magic, RV_FILE_MAGIC, sizeof(h->magic)) != 0
+        || h->version != RV_FILE_VERSION || h->attr_n > h->det_stride
+        || h->set_n == 0)
+        return false;
+    rv_file_header_init(&e, h->attr_n, h->det_n, h->det_stride, h->set_n,
+        h->flags & RV_FILE_VARIABLE, h->det_r);
+    return e.set_size == h->set_size && h->set_size <= UINT64_MAX / h->set_n
+        && size - sizeof(*h) >= h->set_n * h->set_size;
+}
+
+int rv_file_write(const char *path, const rv_file_header_t *h,
+    const void *image) {
+    char tmp[FILENAME_MAX];
+    FILE *f;
+    size_t size = h->set_n * h->set_size;
+    int res;
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+        return 1;
+    f = fopen(tmp, "wb");
+    if (f == NULL)
+        return 1;
+    res = fwrite(h, sizeof(*h), 1, f) != 1
+        || fwrite(image, 1, size, f) != size;
+    res |= fclose(f) != 0;
+    if (res == 0) {
+#ifdef _WIN32
+        res = !MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING);
+#else
+        res = rename(tmp, path) != 0;
+#endif
+    }
+    if (res)
+        remove(tmp);
+    return res;
+}
+
+void *rv_file_map(const char *path, rv_file_header_t *h, rv_map_t *m) {
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    memset(m, 0, sizeof(*m));
+    m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m->file == INVALID_HANDLE_VALUE) {
+        m->file = NULL;
+        return NULL;
+    }
+    if (!GetFileSizeEx(m->file, &size)
+        || (uint64_t)size.QuadPart < sizeof(*h)) {
+        rv_file_unmap(m);
+        return NULL;
+    }
+    m->size = (size_t)size.QuadPart;
+    m->mapping = CreateFileMappingA(m->file, NULL, PAGE_WRITECOPY, 0, 0,
+        NULL);
+    if (m->mapping != NULL)
+        m->addr = MapViewOfFile(m->mapping, FILE_MAP_COPY, 0, 0, 0);
+#else
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    memset(m, 0, sizeof(*m));
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(*h)) {
+        m->size = (size_t)st.st_size;
+        m->addr = mmap(NULL, m->size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+            fd, 0);
+        if (m->addr == MAP_FAILED)
+            m->addr = NULL;
+    }
+    close(fd);
+#endif
+    if (m->addr == NULL) {
+        rv_file_unmap(m);
+        return NULL;
+    }
+    memcpy(h, m->addr, sizeof(*h));
+    if (!is_header_valid(h, m->size)) {
+        rv_file_unmap(m);
+        return NULL;
+    }
+    return (char *)m->addr + sizeof(*h);
+}
+
+void rv_file_unmap(rv_map_t *m) {
+#ifdef _WIN32
+    if (m->addr != NULL)
+        UnmapViewOfFile(m->addr);
+    if (m->mapping != NULL)
+        CloseHandle(m->mapping);
+    if (m->file != NULL)
+        CloseHandle(m->file);
+    m->mapping = m->file = NULL;
+#else
+    if (m->addr != NULL)
+        munmap(m->addr, m->size);
+#endif
+    m->addr = NULL;
+    m->size = 0;
+}
\ No newline at end of file
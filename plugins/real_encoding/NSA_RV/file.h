@@ -0,0 +1,91 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __NSA_RV_FILE_H__
+#define __NSA_RV_FILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*! Файл набора детекторов.
+    Файл состоит из заголовка и образа наборов, который без изменений
+    используется в памяти: после отображения файла (mmap) predict работает
+    с ним напрямую, без разбора. Каждый набор занимает set_size байт,
+    разделы набора выровнены на RV_FILE_ALIGN байт:
+    центры [det_n X det_stride], радиусы, нормы центров, битовая карта
+    действующих детекторов и два массива счётчиков срабатываний.
+    Числа хранятся в порядке байт машины, записавшей файл; файл с другим
+    порядком байт не пройдёт проверку версии.
+*/
+#define RV_FILE_MAGIC "NSA_RV\r\n"
+#define RV_FILE_VERSION 1
+#define RV_FILE_ALIGN 64
+// Флаги заголовка
+#define RV_FILE_VARIABLE 0x1    // Детекторы переменного радиуса
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t attr_n;
+    uint64_t det_n;
+    uint64_t det_stride;
+    uint64_t set_n;
+    uint64_t set_size;          // Размер одного набора в байтах
+    double det_r;
+} rv_file_header_t;
+
+// Разделы одного набора внутри образа
+typedef struct {
+    double *centers;
+    double *radii;
+    double *norms;
+    uint64_t *valid;            // Бит k - детектор k действует
+    uint64_t *count_f;
+    uint64_t *count_p;
+} rv_set_t;
+
+#define RV_VALID_GET(bits, k) (((bits)[(k) / 64] >> ((k) % 64)) & 1)
+
+/*! Заполняет заголовок и считает размер набора.
+*/
+void rv_file_header_init(rv_file_header_t *h, uint64_t attr_n,
+    uint64_t det_n, uint64_t det_stride, uint64_t set_n, bool is_variable,
+    double det_r);
+
+/*! Раскладывает набор q по образу base.
+*/
+void rv_set_bind(rv_set_t *s, const rv_file_header_t *h, void *base,
+    size_t q);
+
+// Отображение файла в память
+typedef struct {
+    void *addr;
+    size_t size;
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#endif
+} rv_map_t;
+
+/*! Записывает заголовок и образ наборов во временный файл и заменяет им
+    path, поэтому процессы, уже отобразившие старый файл, его не увидят
+    частично изменённым.
+    \return 0 - успешно, 1 - ошибка записи.
+*/
+int rv_file_write(const char *path, const rv_file_header_t *h,
+    const void *image);
+
+/*! Отображает файл в память и проверяет заголовок.
+    Страницы отображаются с копированием при записи: счётчики можно менять,
+    не затрагивая файл, а неизменённые страницы остаются общими для всех
+    процессов.
+    \param h Заголовок файла.
+    \return Образ наборов или NULL, если файл не открыт или повреждён.
+*/
+void *rv_file_map(const char *path, rv_file_header_t *h, rv_map_t *m);
+
+void rv_file_unmap(rv_map_t *m);
+
+#endif
\ No newline at end of file
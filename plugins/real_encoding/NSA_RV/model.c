@@ -0,0 +1,472 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include "model.h"
+#include <iam/logger.h>
+#include <iam/worker.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "distance.h"
+#include "random.h"
+#include "block.h"
+
+#define DET_ALIGN 64
+// Количество сдвигов детектора к ближайшей строке "чужих"
+#define SHIFT_MAX 3
+#define RAND(min, max) rv_rng_uniform(rng, min, max)
+#define RAND_DET RAND(-4, 4)
+#define RAND_R RAND(0, 3)
+
+#define DETECTOR(m, k) RV_MODEL_DETECTOR(m, k)
+#define RADIUS(m, k) ((m)->cfg.is_variable ? (m)->set.radii[k] \
+    : (m)->cfg.det_r)
+
+// predict вызывается libIAM одновременно для разных частей матрицы
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define ATOMIC_INC(p) _InterlockedIncrement64((volatile __int64 *)(p))
+    #define ATOMIC_OR(p, v) _InterlockedOr64((volatile __int64 *)(p), (v))
+    #define ATOMIC_AND(p, v) _InterlockedAnd64((volatile __int64 *)(p), (v))
+#else
+    #define ATOMIC_INC(p) __atomic_fetch_add(p, 1, __ATOMIC_RELAXED)
+    #define ATOMIC_OR(p, v) __atomic_fetch_or(p, v, __ATOMIC_RELAXED)
+    #define ATOMIC_AND(p, v) __atomic_fetch_and(p, v, __ATOMIC_RELAXED)
+#endif
+
+// Части fit могут делить одно слово битовой карты
+#define SET_VALID(bits, k, v) ((v) \
+    ? ATOMIC_OR(&(bits)[(k) / 64], 1ULL << ((k) % 64)) \
+    : ATOMIC_AND(&(bits)[(k) / 64], ~(1ULL << ((k) % 64))))
+
+static void *aligned_new(size_t size) {
+#ifdef _WIN32
+    return _aligned_malloc(size, DET_ALIGN);
+#else
+    void *p;
+    return posix_memalign(&p, DET_ALIGN, size) == 0 ? p : NULL;
+#endif
+}
+
+static void aligned_free(void *p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+static void update_norms(rv_model_t *m, size_t beg, size_t end) {
+    size_t k;
+    for (k = beg; k < end; k++)
+        m->set.norms[k] = rv_norm(DETECTOR(m, k), m->cfg.attr_n);
+}
+
+typedef struct {
+    rv_model_t *model;
+    const double *inX;
+    size_t col_n;
+    size_t part_n;          // Количество детекторов в одной части
+    rv_tree_t *self;        // Индекс строк с inY == 0
+    rv_tree_t *nonself;     // Индекс строк с inY != 0
+    rv_rows_t self_rows;    // Строки с inY == 0 для блочной проверки
+    uint64_t failed;        // Частей, не получивших память
+} fit_task_t;
+
+// Кандидаты в детекторы, сгенерированные и проверенные одним блоком
+typedef struct {
+    double *centers;        // [size X col_n]
+    double *radii;
+    bool *hit;              // true - кандидат накрывает строку "своих"
+    size_t size;
+    size_t pos;
+} cand_pool_t;
+
+static void pool_init(cand_pool_t *pool, size_t cand_n, size_t col_n) {
+    // Блок проверяется по RV_LANES кандидатов
+    pool->size = (cand_n + RV_LANES - 1) / RV_LANES * RV_LANES;
+    pool->pos = pool->size;
+    pool->centers = (double *)malloc(sizeof(double) * pool->size * col_n);
+    pool->radii = (double *)malloc(sizeof(double) * pool->size);
+    pool->hit = (bool *)malloc(sizeof(bool) * pool->size);
+    if (pool->centers == NULL || pool->radii == NULL || pool->hit == NULL)
+        pool->size = 0;
+}
+
+static void pool_free(cand_pool_t *pool) {
+    free(pool->centers);
+    free(pool->radii);
+    free(pool->hit);
+}
+
+// Выдаёт следующего кандидата, при необходимости генерируя новый блок.
+// \return true - кандидат не накрывает ни одной строки "своих".
+static bool pool_next(const fit_task_t *task, cand_pool_t *pool,
+    rv_rng_t *rng, double *detector, double *radius) {
+    const rv_model_t *m = task->model;
+    size_t b, j, col_n = task->col_n;
+    double *c;
+    if (pool->pos == pool->size) {
+        for (b = 0; b < pool->size; b++) {
+            c = pool->centers + b * col_n;
+            for (j = 0; j < col_n; j++)
+                c[j] = RAND_DET;
+            pool->radii[b] = m->cfg.is_variable ? RAND_R : m->cfg.det_r;
+        }
+        if (rv_block_censor(&task->self_rows, pool->centers, pool->size,
+                pool->radii, pool->hit))
+            for (b = 0; b < pool->size; b++)
+                pool->hit[b] = rv_tree_any_within(task->self,
+                    pool->centers + b * col_n, pool->radii[b]) != SIZE_MAX;
+        pool->pos = 0;
+    }
+    b = pool->pos++;
+    memcpy(detector, pool->centers + b * col_n, sizeof(double) * col_n);
+    *radius = pool->radii[b];
+    return !pool->hit[b];
+}
+
+// Генерирует детекторы части t со своим потоком случайных чисел.
+// Каждый детектор изменяется только в одной части, поэтому его состояние
+// записывается без синхронизации.
+static void fit_part(void *ctx, size_t t) {
+    fit_task_t *task = (fit_task_t *)ctx;
+    rv_model_t *m = task->model;
+    const double *begX = task->inX, *r_minX;
+    size_t col_n = task->col_n;
+    size_t k_beg = t * task->part_n, k_end = k_beg + task->part_n;
+    uint8_t attempt = 0, attempt_max = 100, shift = 0;
+    size_t k, i, j;
+    double euclidean = 0, radius, r_min, sum, step, s1, s2 = 0;
+    double *detector;
+    uint64_t *is_valid = m->set.valid;
+    uint64_t *count_f = m->set.count_f, *count_p = m->set.count_p;
+    bool is_variable = m->cfg.is_variable, is_self;
+    double *sq_diff = (double *)malloc(sizeof(double) * col_n);
+    rv_rng_t g, *rng = &g;
+    cand_pool_t pool = { .size = 0 };
+    rv_rng_init(rng, m->cfg.seed, t);
+    if (k_end > m->cfg.det_n)
+        k_end = m->cfg.det_n;
+    if (sq_diff == NULL) {
+        // Непроверенные детекторы части могли бы накрыть "своих"
+        for (k = k_beg; k < k_end; k++)
+            SET_VALID(is_valid, k, false);
+        ATOMIC_INC(&task->failed);
+        return;
+    }
+    if (m->cfg.cand_n > 0)
+        pool_init(&pool, m->cfg.cand_n, col_n);
+    for (k = k_beg; k < k_end; k++) {
+        detector = DETECTOR(m, k);
+        radius = RADIUS(m, k);
+        // Детектор не должен накрывать ни одной строки "своих"
+        is_self = rv_tree_any_within(task->self, detector, radius)
+            != SIZE_MAX;
+        while (is_self && attempt < attempt_max) {
+            attempt++;
+            if (pool.size > 0) {
+                is_self = !pool_next(task, &pool, rng, detector, &radius);
+            } else {
+                for (j = 0; j < col_n; j++)
+                    detector[j] = RAND_DET;
+                if (is_variable)
+                    radius = RAND_R;
+                is_self = attempt < attempt_max && rv_tree_any_within(
+                    task->self, detector, radius) != SIZE_MAX;
+            }
+            if (is_variable)
+                m->set.radii[k] = radius;
+            count_p[k] = 0;
+        }
+        if (attempt < attempt_max) {
+            attempt = 0;
+            // Ближайшая строка "чужих" и строки "чужих" внутри детектора
+            r_min = 1E308;
+            r_minX = NULL;
+            i = rv_tree_nearest(task->nonself, detector, radius, &j, &r_min);
+            count_f[k] = j;
+            if (i != SIZE_MAX)
+                r_minX = begX + i * col_n;
+            euclidean = r_min;
+        } else {
+            count_f[k] = 0;
+            r_minX = NULL;
+        }
+        if (count_f[k] == 0 && count_p[k] < 3 && r_minX != NULL &&
+            shift < SHIFT_MAX) {
+            for (j = 0; j < col_n; j++)
+                sq_diff[j] = pow(detector[j] - r_minX[j], 2);
+            j = 0;
+            while (r_min > radius && attempt < attempt_max) {
+                step = (detector[j] - r_minX[j]) / 4;
+                sum = 0;
+                for (i = 0; i < col_n; i++)
+                    if (i != j)
+                        sum += sq_diff[i];
+                while (euclidean >= r_min && attempt < attempt_max) {
+                    s2 = detector[j] - r_minX[j];
+                    s1 = fabs(s2);
+                    s2 = fabs(s2 - step);
+                    if (s2 < s1) {
+                        detector[j] -= step;
+                        s2 *= s2;
+                        euclidean = sqrt(s2 + sum);
+                        attempt = 0;
+                    } else {
+                        if (s2 > s1)
+                            step = -step;
+                        else
+                            step = step / 2;
+                        attempt++;
+                    }
+                }
+                r_min = euclidean;
+                sq_diff[j] = s2;
+                j++;
+                if (j == col_n)
+                    j = 0;
+            }
+            if (attempt < attempt_max) {
+                count_p[k] = 0;
+                k--; // Повторная проверка
+                attempt = 0;
+                shift++;
+                continue;
+            }
+        }
+        shift = 0;
+        if (attempt == attempt_max) {
+            attempt = 0;
+            SET_VALID(is_valid, k, false);
+        } else {
+            SET_VALID(is_valid, k, true);
+        }
+    }
+    update_norms(m, k_beg, k_end);
+    pool_free(&pool);
+    free(sq_diff);
+}
+
+// Номера строк, для которых (inY[i] == 0) == is_self
+static size_t *select_rows(const uint8_t *inY, size_t row_n, bool is_self,
+    size_t *n) {
+    size_t i, *ids = (size_t *)malloc(sizeof(size_t) * (row_n + 1));
+    *n = 0;
+    if (ids != NULL)
+        for (i = 0; i < row_n; i++)
+            if ((inY[i] == 0) == is_self)
+                ids[(*n)++] = i;
+    return ids;
+}
+
+static void fit_task_free(fit_task_t *task) {
+    rv_tree_free(task->self);
+    rv_tree_free(task->nonself);
+    rv_rows_free(&task->self_rows);
+}
+
+static int fit_task_init(fit_task_t *task, rv_model_t *m, const double *inX,
+    const uint8_t *inY, size_t row_n, size_t col_n) {
+    size_t *self_ids, *nonself_ids, self_n, nonself_n;
+    int res = 0;
+    task->model = m;
+    task->inX = inX;
+    task->col_n = col_n;
+    task->failed = 0;
+    self_ids = select_rows(inY, row_n, true, &self_n);
+    nonself_ids = select_rows(inY, row_n, false, &nonself_n);
+    task->self = task->nonself = NULL;
+    task->self_rows.rows = task->self_rows.norm2 = NULL;
+    if (self_ids == NULL || nonself_ids == NULL)
+        res = 1;
+    if (res == 0) {
+        task->self = rv_tree_build(inX, col_n, col_n, self_ids, self_n,
+            NULL, 0);
+        task->nonself = rv_tree_build(inX, col_n, col_n, nonself_ids,
+            nonself_n, NULL, 0);
+        res = task->self == NULL || task->nonself == NULL;
+    }
+    if (res == 0 && m->cfg.cand_n > 0)
+        res = rv_rows_init(&task->self_rows, inX, col_n, col_n,
+            self_ids, self_n);
+    free(self_ids);
+    free(nonself_ids);
+    if (res)
+        fit_task_free(task);
+    return res;
+}
+
+// Строит дерево шаров по действующим детекторам модели
+static void build_tree(rv_model_t *m) {
+    size_t k, n = 0, *ids, det_n = m->cfg.det_n;
+    rv_tree_free(m->tree);
+    m->tree = NULL;
+    if (m->cfg.tree_min == 0 || det_n < m->cfg.tree_min)
+        return;
+    ids = (size_t *)malloc(sizeof(size_t) * det_n);
+    if (ids == NULL)
+        return;
+    for (k = 0; k < det_n; k++)
+        if (RV_VALID_GET(m->set.valid, k))
+            ids[n++] = k;
+    m->tree = rv_tree_build(m->set.centers, m->stride, m->cfg.attr_n,
+        ids, n, m->cfg.is_variable ? m->set.radii : NULL, m->cfg.det_r);
+    free(ids);
+}
+
+int rv_model_fit(rv_model_t *m, const double *inX, const uint8_t *inY,
+    size_t row_n, size_t col_n) {
+    size_t part_count = iam_worker_count(), det_n = m->cfg.det_n;
+    fit_task_t task;
+    if (fit_task_init(&task, m, inX, inY, row_n, col_n)) {
+        iam_logger_puts(m->cfg.log_id, IAM_ERROR,
+            "Not enough memory to fit the model.");
+        return 1;
+    }
+    if (part_count > det_n)
+        part_count = det_n > 0 ? det_n : 1;
+    task.part_n = (det_n + part_count - 1) / part_count;
+    iam_worker_run(part_count, fit_part, &task);
+    fit_task_free(&task);
+    build_tree(m);
+    if (task.failed > 0) {
+        iam_logger_putf(m->cfg.log_id, IAM_ERROR, "Not enough memory to fit "
+            "%llu of %llu parts; their detectors are disabled.",
+            (unsigned long long)task.failed, (unsigned long long)part_count);
+        return 1;
+    }
+    if (m->path != NULL && rv_file_write(m->path, &m->header, m->image)) {
+        iam_logger_putf(m->cfg.log_id, IAM_ERROR,
+            "Failed to write the detector file %s.", m->path);
+        return 1;
+    }
+    return 0;
+}
+
+void rv_model_predict(rv_model_t *m, const double *inX, uint8_t *outY,
+    size_t row_n, size_t col_n) {
+    size_t k, i, det_n = m->cfg.det_n;
+    double radius, norm_x = 0;
+    const uint64_t *is_valid = m->set.valid;
+    const double *norm = m->set.norms;
+    uint64_t *count_p = m->set.count_p;
+    // Нормы детекторов посчитаны по attr_n измерениям
+    bool is_norm = col_n == m->cfg.attr_n;
+    if (m->tree != NULL && is_norm) {
+        for (i = 0; i < row_n; i++, inX += col_n) {
+            k = rv_tree_find(m->tree, inX);
+            outY[i] = k != SIZE_MAX;
+            if (outY[i])
+                ATOMIC_INC(&count_p[k]);
+        }
+        return;
+    }
+    for (i = 0; i < row_n; i++) {
+        outY[i] = 0;
+        if (is_norm)
+            norm_x = rv_norm(inX, col_n);
+        for (k = 0; k < det_n; k++) {
+            if (!RV_VALID_GET(is_valid, k))
+                continue;
+            radius = RADIUS(m, k);
+            if (is_norm && rv_is_far(norm[k], norm_x, radius))
+                continue;
+            if (rv_is_inside(DETECTOR(m, k), inX, col_n, radius)) {
+                ATOMIC_INC(&count_p[k]);
+                outY[i] = 1;
+                break;
+            }
+        }
+        inX += col_n;
+    }
+}
+
+// Отображает файл модели, если он соответствует её параметрам
+static bool map_detectors(rv_model_t *m) {
+    rv_file_header_t h;
+    const rv_file_header_t *e = &m->header;
+    void *base = rv_file_map(m->path, &h, &m->map);
+    if (base == NULL) {
+        iam_logger_putf(m->cfg.log_id, IAM_WARN, "Failed to map the detector "
+            "file %s, detectors are generated.", m->path);
+        return false;
+    }
+    if (h.attr_n != e->attr_n || h.det_n != e->det_n
+        || h.det_stride != e->det_stride || h.set_n != e->set_n
+        || h.flags != e->flags || (!m->cfg.is_variable && h.det_r != e->det_r)) {
+        rv_file_unmap(&m->map);
+        iam_logger_putf(m->cfg.log_id, IAM_WARN, "The detector file %s does "
+            "not match the settings, detectors are generated.", m->path);
+        return false;
+    }
+    m->image = base;
+    rv_set_bind(&m->set, &m->header, base, 0);
+    iam_logger_putf(m->cfg.log_id, IAM_INFO, "Detectors are mapped from %s.",
+        m->path);
+    return true;
+}
+
+// Заполняет набор случайными детекторами
+static void generate_detectors(rv_model_t *m) {
+    size_t j, k;
+    double *detector;
+    rv_rng_t g, *rng = &g;
+    rv_rng_init(rng, m->cfg.seed, m->cfg.stream);
+    for (k = 0; k < m->cfg.det_n; k++) {
+        detector = DETECTOR(m, k);
+        for (j = 0; j < m->cfg.attr_n; j++)
+            detector[j] = RAND_DET;
+        m->set.radii[k] = RAND_R;
+    }
+    update_norms(m, 0, m->cfg.det_n);
+}
+
+rv_model_t *rv_model_create(const rv_model_config_t *cfg) {
+    rv_model_t *m = (rv_model_t *)calloc(1, sizeof(rv_model_t));
+    size_t size;
+    if (m == NULL)
+        return NULL;
+    m->cfg = *cfg;
+    if (cfg->path != NULL && cfg->path[0] != '\0') {
+        m->path = (char *)malloc(strlen(cfg->path) + 1);
+        if (m->path == NULL) {
+            free(m);
+            return NULL;
+        }
+        strcpy(m->path, cfg->path);
+    }
+    m->cfg.path = m->path;
+    // Строка выравнивается до целого числа кэш-линий
+    m->stride = (cfg->attr_n * sizeof(double) + DET_ALIGN - 1) / DET_ALIGN
+        * DET_ALIGN / sizeof(double);
+    rv_file_header_init(&m->header, cfg->attr_n, cfg->det_n, m->stride, 1,
+        cfg->is_variable, cfg->det_r);
+    if (m->path == NULL || !map_detectors(m)) {
+        // Выравнивание и счётчики образа обнуляются
+        size = m->header.set_size;
+        m->image = aligned_new(size > 0 ? size : DET_ALIGN);
+        if (m->image == NULL) {
+            rv_model_destroy(m);
+            return NULL;
+        }
+        memset(m->image, 0, size);
+        rv_set_bind(&m->set, &m->header, m->image, 0);
+        generate_detectors(m);
+    }
+    build_tree(m);
+    return m;
+}
+
+void rv_model_destroy(rv_model_t *m) {
+    if (m == NULL)
+        return;
+    rv_tree_free(m->tree);
+    if (m->map.addr != NULL)
+        rv_file_unmap(&m->map);
+    else
+        aligned_free(m->image);
+    free(m->path);
+    free(m);
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __NSA_RV_MODEL_H__
+#define __NSA_RV_MODEL_H__
+
+#include <iam/iam.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "file.h"
+#include "tree.h"
+
+/*! Параметры модели, фиксируемые при её создании.
+*/
+typedef struct {
+    uint64_t attr_n;        // Количество измерений детекторов
+    uint64_t det_n;         // Количество детекторов
+    double det_r;           // Радиус детекторов постоянного размера
+    bool is_variable;       // true - детекторы переменного радиуса
+    uint64_t seed;          // Начальное значение генератора
+    uint64_t stream;        // Поток генератора для начального заполнения
+    uint64_t tree_min;      // Детекторов для поиска по дереву (0 - никогда)
+    uint32_t cand_n;        // Размер блока кандидатов (0 - по одному)
+    const char *path;       // Файл детекторов или NULL
+    iam_id_t log_id;        // Модуль, от имени которого пишется лог
+} rv_model_config_t;
+
+/*! Набор детекторов с собственными параметрами.
+    Модели не разделяют состояние, поэтому разные модели можно обучать
+    и опрашивать одновременно. predict одной модели можно вызывать
+    одновременно для разных частей матрицы, fit - только монопольно.
+*/
+typedef struct {
+    rv_model_config_t cfg;
+    char *path;             // Копия cfg.path
+    size_t stride;          // Длина строки центров, кратная кэш-линии
+    // Центры [det_n X stride] и остальные характеристики хранятся одним
+    // образом в формате файла детекторов (file.h): образ либо выделяется,
+    // либо отображается из файла path.
+    rv_file_header_t header;
+    void *image;
+    rv_map_t map;
+    rv_set_t set;
+    rv_tree_t *tree;
+} rv_model_t;
+
+#define RV_MODEL_DETECTOR(m, k) ((m)->set.centers + (k) * (m)->stride)
+
+/*! Создаёт модель: отображает файл cfg->path, если он соответствует
+    параметрам, иначе заполняет набор случайными детекторами.
+    \return Модель или NULL при нехватке памяти.
+*/
+rv_model_t *rv_model_create(const rv_model_config_t *cfg);
+
+void rv_model_destroy(rv_model_t *m);
+
+/*! Обучает модель и, если задан файл, записывает в него детекторы.
+    \return 0 - успешно, 1 - нехватка памяти или ошибка записи файла.
+*/
+int rv_model_fit(rv_model_t *m, const double *inX, const uint8_t *inY,
+    size_t row_n, size_t col_n);
+
+void rv_model_predict(rv_model_t *m, const double *inX, uint8_t *outY,
+    size_t row_n, size_t col_n);
+
+#endif
\ No newline at end of file
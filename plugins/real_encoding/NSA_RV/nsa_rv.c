@@ -4,9 +4,12 @@
 #include <iam/plugin.h>
 #include <iam/algorithm.h>
 #include <iam/setting.h>
+#include <iam/logger.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
+#include "distance.h"
+#include "model.h"
 
 static iam_metadata_t info = {
     .name = "NSA_RV",
@@ -16,208 +19,238 @@ static iam_metadata_t info = {
 };
 
 #define DET_N 200
-#define RAND(min, max) (double) rand() / RAND_MAX * (max - min) + min
-#define RAND_DET RAND(-4, 4)
-#define RAND_R RAND(0, 3)
+// Количество детекторов, начиная с которого predict использует дерево
+#define TREE_MIN 1000
+// Размер блока кандидатов в детекторы при обучении (0 - по одному)
+#define CAND_N 0
+// Модели, создаваемые при загрузке настроек (прежние 8 наборов)
+#define SLOT_INIT 8
+// Количество моделей, доступных через настройку det_id
+#define SLOT_N 256
+// Поток генератора для начального заполнения модели q
+#define RNG_INIT_STREAM(q) (UINT64_MAX - (q))
 
+#ifdef _MSC_VER
+    #include <intrin.h>
+    #define CAS_PTR(p, old, new) (_InterlockedCompareExchangePointer( \
+        (void *volatile *)(p), (new), (old)) == (old))
+    #define LOAD_PTR(p) (*(void *volatile *)(p))
+#else
+    #define CAS_PTR(p, old, new) __atomic_compare_exchange_n(p, &(old), \
+        new, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+    #define LOAD_PTR(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#endif
+
+iam_id_t plugin_id;
 uint8_t det_id;
 bool isVdetectors = true;
-double **detectors_array[8];
-double *r_array[8];
-bool *detectors_is_valid[8];
-uint64_t *activations_count_f[8];
-uint64_t *activations_count_p[8];
+// Модели, выбираемые настройкой det_id. Каждая модель хранит свой набор
+// детекторов (model.h); модели с номером от SLOT_INIT создаются при первом
+// обращении с текущими настройками.
+rv_model_t *slots[SLOT_N];
+uint64_t inst_n;        // Количество созданных экземпляров
 uint64_t attr_n = 46;
 uint64_t det_n = DET_N;
 double det_r = 1.6;
+uint64_t tree_min = TREE_MIN;
+uint32_t cand_n = CAND_N;
+uint64_t seed = 0;
+char simd[8] = "auto";
+char model[256] = "";
+const char *simd_sel[] = { "scalar", "sse2", "avx2", "avx512", "auto" };
 char msg[255], *msg_p;
 
-void fit(const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
-    uint8_t attempt = 0, attempt_max = 100;
-    size_t k, i, j;
-    double euclidean, radius, r_min, sum, step, s1, s2; 
-    const double *begX = inX, *r_minX;
-    double **detectors = detectors_array[det_id];
-    bool *is_valid = detectors_is_valid[det_id];
-    double *sq_diff = (double *)malloc(sizeof(double) * col_n);
-    for (k = 0; k < det_n; k++) {
-        inX = begX;
-        r_min = 1E308;
-        r_minX = NULL;
-        radius = isVdetectors ? r_array[det_id][k] : det_r;
-        for (i = 0; i < row_n; i++) {
-            if (attempt == attempt_max)
-                break;
-            euclidean = 0;
-            for (j = 0; j < col_n; j++)
-                euclidean += pow(detectors[k][j] - inX[j], 2);
-            euclidean = sqrt(euclidean);
-            if (inY[i] == 0) {
-                if (euclidean <= radius) {
-                    for (j = 0; j < col_n; j++)
-                        detectors[k][j] = RAND_DET;
-                    if (isVdetectors)
-                        r_array[det_id][k] = RAND_R;
-                    activations_count_f[det_id][k] = 0;
-                    activations_count_p[det_id][k] = 0;
-                    i--; // Повторно вектор c новым детектором
-                    attempt++;
-                    continue;
-                } else if (attempt > 0) {
-                    i = 0; // Новый детектор повторно со всеми векторами (сначала)
-                    inX = begX;
-                    attempt = 0;
-                    continue;
-                }
-            } else {
-                if (euclidean < r_min) {
-                    r_min = euclidean;
-                    r_minX = inX;
-                }
-                if (euclidean <= radius)
-                    activations_count_f[det_id][k]++;
-            }
-            inX += col_n;
-        }
-        if (activations_count_f[det_id][k] == 0 &&
-            activations_count_p[det_id][k] < 3 && r_minX != NULL) {
-            for (j = 1; j < col_n; j++)
-                sq_diff[j] = pow(detectors[k][j] - r_minX[j], 2);
-            j = 0;
-            i = (int)(r_minX - begX) / (sizeof(double));
-            while (r_min > radius && attempt < attempt_max) {
-                step = (detectors[k][j] - r_minX[j]) / 4;
-                sum = 0;
-                for (i = 0; i < col_n; i++)
-                    if (i != j)
-                        sum += sq_diff[i];
-                while (euclidean >= r_min && attempt < attempt_max) {
-                    s2 = detectors[k][j] - r_minX[j];
-                    s1 = fabs(s2);
-                    s2 = fabs(s2 - step);
-                    if (s2 < s1) {
-                        detectors[k][j] -= step;
-                        s2 *= s2;
-                        euclidean = sqrt(s2 + sum);
-                        attempt = 0;
-                    } else {
-                        if (s2 > s1) 
-                            step = -step;
-                        else
-                            step = step / 2;
-                        attempt++;
-                    }
-                }
-                r_min = euclidean;
-                sq_diff[j] = s2;
-                j++;
-                if (j == col_n)
-                    j = 0;
-            }
-            if (attempt < attempt_max) {
-                activations_count_p[det_id][k] = 0;
-                k--; // Повторная проверка
-                attempt = 0;
-            }
-        }
-        if (attempt == attempt_max) {
-            msg_p += sprintf(msg_p, " %Id", k);
-            attempt = 0;
-            is_valid[k] = false;
-        } else {
-            is_valid[k] = true;
-        }
+// Создаёт модель по текущим настройкам.
+// \param name Суффикс файла детекторов или NULL - без файла.
+static rv_model_t *create_model(uint64_t stream, const char *name) {
+    char *path = NULL;
+    rv_model_t *m;
+    rv_model_config_t cfg = {
+        .attr_n = attr_n,
+        .det_n = det_n,
+        .det_r = det_r,
+        .is_variable = isVdetectors,
+        .seed = seed,
+        .stream = stream,
+        .tree_min = tree_min,
+        .cand_n = cand_n,
+        .path = NULL,
+        .log_id = plugin_id
+    };
+    if (model[0] != '\0' && name != NULL) {
+        path = (char *)malloc(strlen(model) + strlen(name) + 2);
+        if (path == NULL)
+            return NULL;
+        sprintf(path, "%s.%s", model, name);
+        cfg.path = path;
+    }
+    m = rv_model_create(&cfg);
+    free(path);
+    return m;
+}
+
+// Возвращает модель q, создавая её при первом обращении.
+// predict вызывается libIAM одновременно для разных частей матрицы,
+// поэтому модель публикуется атомарно.
+static rv_model_t *get_model(size_t q) {
+    rv_model_t *m = (rv_model_t *)LOAD_PTR(&slots[q]), *old;
+    char name[4];
+    if (m != NULL)
+        return m;
+    sprintf(name, "%u", (unsigned)q);
+    m = create_model(RNG_INIT_STREAM(q), name);
+    if (m == NULL)
+        iam_logger_putf(plugin_id, IAM_ERROR,
+            "Not enough memory for the detector set %u.", (unsigned)q);
+    old = NULL;
+    if (m != NULL && !CAS_PTR(&slots[q], old, m)) {
+        rv_model_destroy(m);
+        m = (rv_model_t *)LOAD_PTR(&slots[q]);
     }
-    free(sq_diff);
+    return m;
+}
+
+static void free_models(void) {
+    size_t q;
+    for (q = 0; q < SLOT_N; q++) {
+        rv_model_destroy(slots[q]);
+        slots[q] = NULL;
+    }
+}
+
+void fit(const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
+    size_t k;
+    rv_model_t *m = get_model(det_id);
+    if (m == NULL || rv_model_fit(m, inX, inY, row_n, col_n))
+        return;
+    for (k = 0; k < m->cfg.det_n; k++)
+        if (!RV_VALID_GET(m->set.valid, k) && msg_p + 22 < msg + sizeof(msg))
+            msg_p += sprintf(msg_p, " %"PRIu64, (uint64_t)k);
 }
 
 void predict(const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
-    size_t k, i, j;
-    double euclidean, radius;
-    double **detectors = detectors_array[det_id];
-    bool *is_valid = detectors_is_valid[det_id];
-    for (i = 0; i < row_n; i++) {
-        outY[i] = 0;
-        for (k = 0; k < det_n; k++) {
-            if (!is_valid[k])
-                continue;
-            euclidean = 0;
-            radius = isVdetectors ? r_array[det_id][k] : det_r;
-            for (j = 0; j < col_n; j++)
-                euclidean += pow(detectors[k][j] - inX[j], 2);
-            euclidean = sqrt(euclidean);
-            if (euclidean < radius) {
-                activations_count_p[det_id][k]++;
-                outY[i] = 1;
-                break;
-            }
-        }
-        inX += col_n;
+    rv_model_t *m = get_model(det_id);
+    if (m != NULL)
+        rv_model_predict(m, inX, outY, row_n, col_n);
+    else
+        memset(outY, 0, row_n);
+}
+
+// Анализ пакета векторов совпадает с predict по ним
+static void analyze_batch(iam_id_t id, const double *vectors, size_t n,
+    size_t k, uint8_t *out) {
+    predict(vectors, out, n, k);
+}
+
+// Экземпляр - отдельная модель, не связанная с det_id. Начальное заполнение
+// берётся из потоков генератора после потоков моделей det_id.
+static void *inst_create(iam_id_t id, const char *name) {
+    rv_model_t *m = create_model(RNG_INIT_STREAM(SLOT_N + inst_n), name);
+    if (m == NULL) {
+        iam_logger_puts(id, IAM_ERROR, "Failed to create a model instance.");
+        return NULL;
     }
+    inst_n++;
+    return m;
+}
+
+static void inst_destroy(iam_id_t id, void *ctx) {
+    rv_model_destroy((rv_model_t *)ctx);
 }
 
-#define NEW_M(type, var, count) \
-    var = (type *)malloc(sizeof(type) * count)
-#define NEW_C(type, var, count) \
-    var = (type *)calloc(sizeof(type) * count, sizeof(type))
+static void inst_fit(void *ctx, const double *inX, const uint8_t *inY,
+    size_t row_n, size_t col_n) {
+    rv_model_fit((rv_model_t *)ctx, inX, inY, row_n, col_n);
+}
+
+static void inst_predict(void *ctx, const double *inX, uint8_t *outY,
+    size_t row_n, size_t col_n) {
+    rv_model_predict((rv_model_t *)ctx, inX, outY, row_n, col_n);
+}
+
+static void inst_analyze_batch(void *ctx, const double *vectors, size_t n,
+    size_t k, uint8_t *out) {
+    rv_model_predict((rv_model_t *)ctx, vectors, out, n, k);
+}
+
+static void select_simd(iam_id_t id) {
+    rv_simd_t req = RV_SIMD_AUTO, res;
+    for (size_t i = 0; i < sizeof(simd_sel) / sizeof(*simd_sel); i++)
+        if (strcmp(simd, simd_sel[i]) == 0)
+            req = (rv_simd_t)i;
+    res = rv_distance_init(req);
+    iam_logger_putf(id, IAM_INFO, "Distance kernel: %s (requested %s).",
+        rv_distance_name(res), rv_distance_name(req));
+}
 
 static void load_setting(iam_id_t id) {
-    size_t q, j, k;
-    for (q = 0; q < 8; q++) {
-        NEW_C(uint64_t, activations_count_f[q], det_n);
-        NEW_C(uint64_t, activations_count_p[q], det_n);
-        NEW_M(double, r_array[q], det_n);  
-        NEW_M(double *, detectors_array[q], det_n);
-        NEW_C(bool, detectors_is_valid[q], det_n); 
-        for (k = 0; k < det_n; k++) {
-            NEW_M(double, detectors_array[q][k], attr_n);
-            for (j = 0; j < attr_n; j++) {
-                detectors_array[q][k][j] = RAND_DET;
-            }
-            r_array[q][k] = RAND_R;
-        }         
-    }
+    size_t q;
+    select_simd(id);
+    free_models();
+    for (q = 0; q < SLOT_INIT; q++)
+        get_model(q);
     msg_p = msg;
     msg_p += sprintf(msg_p, "%s", "Вad detectors:");
 }
 
 int nsa_rv_init(iam_id_t id) {
+    iam_setting_t *s;
+    plugin_id = id;
     iam_setting_reg_uint64(id, "attr_n", "Number of attributes.", &attr_n);
     iam_setting_reg_uint64(id, "det_n", "Number of detectors.", &det_n);
     iam_setting_reg_udouble(id, "det_r", "Detector radius.", &det_r);
     iam_setting_reg_bool(id, "isVdetectors",
         "Is variable size detector.", &isVdetectors);
-    iam_setting_reg_uint8(id, "det_id", "Detector set ID", &det_id);
+    iam_setting_reg_uint8(id, "det_id", "Detector set ID (model number).",
+        &det_id);
+    iam_setting_reg_uint64(id, "seed", "Random number generator seed.", &seed);
+    iam_setting_reg_uint64(id, "tree_min", "Minimum number of detectors "
+        "to search them with a ball tree (0 - never).", &tree_min);
+    iam_setting_reg_str(id, "model", "Detector file prefix: set q (or a "
+        "named instance) is mapped from <model>.<q or name> if it matches "
+        "the settings and written there after fit (empty - none).",
+        model, sizeof(model));
+    iam_setting_reg_uint32(id, "cand_n", "Number of candidate detectors "
+        "generated and censored in one block (0 - one by one).", &cand_n);
+    s = iam_setting_reg_str(id, "simd", "Distance kernel: "
+        "auto, scalar, sse2, avx2, avx512.", simd, sizeof(simd));
+    iam_setting_set_str_select(s, simd_sel,
+        sizeof(simd_sel) / sizeof(*simd_sel));
     iam_setting_reg_callback(id, load_setting);
+    rv_distance_init(RV_SIMD_AUTO);
     iam_real_alg_t *ra = iam_algorithm_reg_real(id);
     iam_real_alg_reg_fit(ra, fit);
     iam_real_alg_reg_predict(ra, predict);
+    iam_real_alg_reg_parallel(ra, true);
+    iam_real_alg_reg_instance(ra, inst_create, inst_destroy);
+    iam_real_alg_reg_ctx(ra, NULL, NULL, inst_fit, inst_predict);
+    iam_real_alg_reg_batch(ra, NULL, analyze_batch);
+    iam_real_alg_reg_batch_ctx(ra, NULL, inst_analyze_batch);
     return 0;
 }
 
 void nsa_rv_exit(iam_id_t id) {
-    size_t i, j;
+    size_t i, j, n;
+    rv_model_t *m;
     FILE *f = fopen("activations_count.txt", "w");
     if (f == NULL) {
         printf("Failed to open the file activations_count.txt.");
+        free_models();
         return;
     }
-    for (i = 0; i < 8; i++){
-        for (j = 0; j < det_n; j++) {
-            free(detectors_array[i][j]);
+    for (n = SLOT_N; n > SLOT_INIT && slots[n - 1] == NULL; n--);
+    for (i = 0; i < n; i++){
+        m = slots[i];
+        for (j = 0; m != NULL && j < m->cfg.det_n; j++) {
             fprintf(f, "%"PRId64",%"PRId64,
-                activations_count_f[i][j],
-                activations_count_p[i][j]);
-            if (j < det_n - 1)
+                m->set.count_f[j],
+                m->set.count_p[j]);
+            if (j < m->cfg.det_n - 1)
                 fputs(",", f);
         }
         fputs("\n", f);
-        free(r_array[i]);
-        free(detectors_array[i]);
-        free(detectors_is_valid[i]);
-        free(activations_count_f[i]);
-        free(activations_count_p[i]);
     }
+    free_models();
     fputs(msg, f);
     fclose(f);
 }
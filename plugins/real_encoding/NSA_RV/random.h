@@ -0,0 +1,45 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __NSA_RV_RANDOM_H__
+#define __NSA_RV_RANDOM_H__
+
+#include <stdint.h>
+
+/*! Генератор на основе счётчика: значение определяется только ключом
+    потока и номером обращения, поэтому потоки не зависят друг от друга
+    и от порядка выполнения.
+*/
+typedef struct {
+    uint64_t key;
+    uint64_t ctr;
+} rv_rng_t;
+
+#define RV_RNG_GAMMA 0x9E3779B97F4A7C15ULL
+
+// Финальное перемешивание SplitMix64
+static inline uint64_t rv_rng_mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*! Инициализирует поток stream для начального значения seed.
+*/
+static inline void rv_rng_init(rv_rng_t *g, uint64_t seed, uint64_t stream) {
+    g->key = rv_rng_mix(seed ^ rv_rng_mix(stream + RV_RNG_GAMMA));
+    g->ctr = 0;
+}
+
+static inline uint64_t rv_rng_next(rv_rng_t *g) {
+    return rv_rng_mix(g->key + ++g->ctr * RV_RNG_GAMMA);
+}
+
+/*! Равномерно распределённое число из [min; max).
+*/
+static inline double rv_rng_uniform(rv_rng_t *g, double min, double max) {
+    return (rv_rng_next(g) >> 11) * (1.0 / 9007199254740992.0)
+        * (max - min) + min;
+}
+
+#endif
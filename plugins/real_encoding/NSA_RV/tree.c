@@ -0,0 +1,274 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include "tree.h"
+#include "distance.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Максимальное количество точек в листе
+#define RV_LEAF 16
+
+#define POINT(t, k) ((t)->points + (k) * (t)->stride)
+#define RADIUS(t, k) ((t)->radii != NULL ? (t)->radii[k] : (t)->radius)
+#define CENTER(t, node) ((t)->centers + (node) * (t)->dim)
+// Точка и радиус на позиции i в порядке листьев
+#define LEAF_POINT(t, i) ((t)->leaf_points + (i) * (t)->dim)
+#define LEAF_RADIUS(t, i) ((t)->leaf_radii[i])
+
+static int cmp_idx(const void *a, const void *b) {
+    size_t x = *(const size_t *)a, y = *(const size_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Выбор Хоара: idx[beg..end) упорядочивается так, что idx[mid] стоит
+// на своём месте по координате j
+static void select_nth(const rv_tree_t *t, size_t beg, size_t mid,
+    size_t end, size_t j) {
+    size_t *idx = t->idx, tmp;
+    ptrdiff_t l, r, lo = (ptrdiff_t)beg, hi = (ptrdiff_t)end - 1;
+    double pivot;
+    while (lo < hi) {
+        pivot = POINT(t, idx[lo + (hi - lo) / 2])[j];
+        l = lo;
+        r = hi;
+        while (l <= r) {
+            while (POINT(t, idx[l])[j] < pivot)
+                l++;
+            while (POINT(t, idx[r])[j] > pivot)
+                r--;
+            if (l <= r) {
+                tmp = idx[l];
+                idx[l++] = idx[r];
+                idx[r--] = tmp;
+            }
+        }
+        if ((ptrdiff_t)mid <= r)
+            hi = r;
+        else if ((ptrdiff_t)mid >= l)
+            lo = l;
+        else
+            return;
+    }
+}
+
+// Строит поддерево над idx[beg..end), возвращает номер узла или 0
+static size_t build(rv_tree_t *t, size_t beg, size_t end) {
+    size_t node = t->node_n++, i, j, k, split = 0, mid;
+    rv_tree_node_t *p = &t->nodes[node];
+    double *c = CENTER(t, node), d, lo, hi, spread = -1;
+    p->beg = beg;
+    p->end = end;
+    p->left = p->right = 0;
+    p->min_k = SIZE_MAX;
+    p->bound = 0;
+    for (j = 0; j < t->dim; j++) {
+        c[j] = 0;
+        lo = 1E308;
+        hi = -1E308;
+        for (i = beg; i < end; i++) {
+            d = POINT(t, t->idx[i])[j];
+            c[j] += d;
+            if (d < lo)
+                lo = d;
+            if (d > hi)
+                hi = d;
+        }
+        c[j] /= end - beg;
+        if (hi - lo > spread) {
+            spread = hi - lo;
+            split = j;
+        }
+    }
+    for (i = beg; i < end; i++) {
+        k = t->idx[i];
+        d = sqrt(rv_sqdist(POINT(t, k), c, t->dim)) + RADIUS(t, k);
+        if (d > p->bound)
+            p->bound = d;
+        if (k < p->min_k)
+            p->min_k = k;
+    }
+    if (end - beg <= RV_LEAF || spread <= 0) {
+        // Точки листа проверяются по возрастанию номеров
+        qsort(t->idx + beg, end - beg, sizeof(size_t), cmp_idx);
+        return node;
+    }
+    mid = beg + (end - beg) / 2;
+    select_nth(t, beg, mid, end, split);
+    p->left = build(t, beg, mid);
+    p->right = build(t, mid, end);
+    return node;
+}
+
+rv_tree_t *rv_tree_build(const double *points, size_t stride, size_t dim,
+    const size_t *ids, size_t n, const double *radii, double radius) {
+    // Делится только узел больше RV_LEAF точек, поэтому в каждом листе
+    // не меньше RV_LEAF / 2 точек, а листьев не больше n / (RV_LEAF / 2)
+    size_t node_max = n / (RV_LEAF / 2) * 2 + 1, i;
+    rv_tree_t *t = (rv_tree_t *)calloc(1, sizeof(rv_tree_t));
+    if (t == NULL)
+        return NULL;
+    t->points = points;
+    t->stride = stride;
+    t->dim = dim;
+    t->n = n;
+    t->radii = radii;
+    t->radius = radius;
+    t->nodes = (rv_tree_node_t *)malloc(sizeof(rv_tree_node_t) * node_max);
+    t->centers = (double *)malloc(sizeof(double) * node_max * dim);
+    t->idx = (size_t *)malloc(sizeof(size_t) * (n + 1));
+    t->leaf_points = (double *)malloc(sizeof(double) * (n * dim + 1));
+    t->leaf_radii = (double *)malloc(sizeof(double) * (n + 1));
+    if (t->nodes == NULL || t->centers == NULL || t->idx == NULL
+        || t->leaf_points == NULL || t->leaf_radii == NULL) {
+        rv_tree_free(t);
+        return NULL;
+    }
+    memcpy(t->idx, ids, sizeof(size_t) * n);
+    if (n > 0)
+        build(t, 0, n);
+    for (i = 0; i < n; i++) {
+        memcpy(LEAF_POINT(t, i), POINT(t, t->idx[i]), sizeof(double) * dim);
+        t->leaf_radii[i] = RADIUS(t, t->idx[i]);
+    }
+    return t;
+}
+
+typedef struct {
+    const double *x;
+    double radius;      // Добавляется к радиусу каждой точки
+    bool is_closed;     // true - граница шара входит в шар
+    bool is_any;        // true - подходит любая точка, не только первая
+} rv_query_t;
+
+static bool is_match(const rv_tree_t *t, const rv_query_t *q, size_t i) {
+    double r = LEAF_RADIUS(t, i) + q->radius;
+    return q->is_closed ? rv_is_within(LEAF_POINT(t, i), q->x, t->dim, r)
+        : rv_is_inside(LEAF_POINT(t, i), q->x, t->dim, r);
+}
+
+// Неравенство треугольника: |x - p| >= |x - c| - |p - c| > r + radius
+static bool is_far(const rv_tree_t *t, size_t node, const rv_query_t *q,
+    double *d) {
+    double bound = t->nodes[node].bound + q->radius;
+    *d = sqrt(rv_sqdist(q->x, CENTER(t, node), t->dim));
+    return *d - bound > (*d + bound) * RV_BAND;
+}
+
+static void find(const rv_tree_t *t, size_t node, const rv_query_t *q,
+    size_t *best) {
+    const rv_tree_node_t *p = &t->nodes[node];
+    double d;
+    size_t i, k;
+    if (p->min_k >= *best || (q->is_any && *best != SIZE_MAX)
+        || is_far(t, node, q, &d))
+        return;
+    if (p->left == 0) {
+        for (i = p->beg; i < p->end; i++) {
+            k = t->idx[i];
+            if (k >= *best)
+                break;
+            if (is_match(t, q, i)) {
+                *best = k;
+                break;
+            }
+        }
+        return;
+    }
+    if (t->nodes[p->left].min_k <= t->nodes[p->right].min_k) {
+        find(t, p->left, q, best);
+        find(t, p->right, q, best);
+    } else {
+        find(t, p->right, q, best);
+        find(t, p->left, q, best);
+    }
+}
+
+size_t rv_tree_find(const rv_tree_t *tree, const double *x) {
+    rv_query_t q = { .x = x, .radius = 0, .is_closed = false,
+        .is_any = false };
+    size_t best = SIZE_MAX;
+    if (tree->n > 0)
+        find(tree, 0, &q, &best);
+    return best;
+}
+
+size_t rv_tree_any_within(const rv_tree_t *tree, const double *x,
+    double radius) {
+    rv_query_t q = { .x = x, .radius = radius, .is_closed = true,
+        .is_any = true };
+    size_t best = SIZE_MAX;
+    if (tree->n > 0)
+        find(tree, 0, &q, &best);
+    return best;
+}
+
+typedef struct {
+    size_t k;       // Ближайшая точка
+    double d2;      // Квадрат расстояния до неё
+    size_t count;   // Точки, для которых is_match
+} rv_nearest_t;
+
+// Обходит узлы, в которых может быть точка ближе найденной или ещё
+// не посчитанная точка в пределах radius
+static void nearest(const rv_tree_t *t, size_t node, const rv_query_t *q,
+    rv_nearest_t *res, bool is_counted) {
+    const rv_tree_node_t *p = &t->nodes[node];
+    double d, lb, r;
+    size_t i, k, l;
+    if (is_far(t, node, q, &d)) {
+        lb = d - p->bound;
+        if (lb * lb >= res->d2)
+            return;
+        is_counted = true;
+    } else if (!is_counted && t->radii == NULL && t->radius == 0
+        && q->radius - (d + p->bound) > (d + p->bound) * RV_BAND) {
+        // Без радиусов точек узел целиком в пределах radius
+        res->count += p->end - p->beg;
+        is_counted = true;
+    }
+    if (p->left == 0) {
+        for (i = p->beg; i < p->end; i++) {
+            k = t->idx[i];
+            d = rv_sqdist(LEAF_POINT(t, i), q->x, t->dim);
+            if (d < res->d2) {
+                res->d2 = d;
+                res->k = k;
+            }
+            r = LEAF_RADIUS(t, i) + q->radius;
+            // Точная проверка только около границы
+            if (!is_counted && d <= r * r * (1 + 2 * RV_BAND))
+                res->count += is_match(t, q, i);
+        }
+        return;
+    }
+    // Сначала ближний потомок
+    l = rv_sqdist(q->x, CENTER(t, p->left), t->dim)
+        <= rv_sqdist(q->x, CENTER(t, p->right), t->dim);
+    nearest(t, l ? p->left : p->right, q, res, is_counted);
+    nearest(t, l ? p->right : p->left, q, res, is_counted);
+}
+
+size_t rv_tree_nearest(const rv_tree_t *tree, const double *x,
+    double radius, size_t *count, double *dist) {
+    rv_query_t q = { .x = x, .radius = radius, .is_closed = true,
+        .is_any = false };
+    rv_nearest_t res = { .k = SIZE_MAX, .d2 = INFINITY, .count = 0 };
+    if (tree->n > 0)
+        nearest(tree, 0, &q, &res, false);
+    if (res.k != SIZE_MAX)
+        *dist = rv_dist_ref(POINT(tree, res.k), x, tree->dim);
+    *count = res.count;
+    return res.k;
+}
+
+void rv_tree_free(rv_tree_t *tree) {
+    if (tree == NULL)
+        return;
+    free(tree->nodes);
+    free(tree->centers);
+    free(tree->idx);
+    free(tree->leaf_points);
+    free(tree->leaf_radii);
+    free(tree);
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __NSA_RV_TREE_H__
+#define __NSA_RV_TREE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*! Узел дерева шаров.
+*/
+typedef struct {
+    size_t beg;     // Диапазон idx, который покрывает узел
+    size_t end;
+    size_t left;    // Дочерние узлы, 0 - лист
+    size_t right;
+    size_t min_k;   // Наименьший номер точки в поддереве
+    double bound;   // max(|p - center| + r) по точкам поддерева
+} rv_tree_node_t;
+
+/*! Дерево шаров над центрами детекторов с учётом их радиусов.
+    Для последовательного чтения при поиске точки копируются в порядке
+    листьев; points и radii должны жить, пока строится дерево.
+*/
+typedef struct {
+    rv_tree_node_t *nodes;
+    size_t node_n;
+    double *centers;        // Центры узлов [node_n X dim]
+    size_t *idx;            // Номера точек, упорядоченные по листьям
+    double *leaf_points;    // Точки в порядке idx [n X dim]
+    double *leaf_radii;     // Радиусы в порядке idx
+    size_t n;
+    size_t dim;
+    size_t stride;
+    const double *points;   // [.. X stride]
+    const double *radii;    // NULL - у всех точек радиус radius
+    double radius;
+} rv_tree_t;
+
+/*! Строит дерево по точкам с номерами ids.
+    \param points Точки [.. X stride].
+    \param stride Шаг между точками.
+    \param dim Количество измерений.
+    \param ids Номера точек, попадающих в дерево.
+    \param n Количество номеров.
+    \param radii Радиусы точек или NULL.
+    \param radius Общий радиус, если radii == NULL.
+    \return Дерево или NULL при нехватке памяти.
+*/
+rv_tree_t *rv_tree_build(const double *points, size_t stride, size_t dim,
+    const size_t *ids, size_t n, const double *radii, double radius);
+
+/*! Ищет точку с наименьшим номером, в шар которой попадает x
+    (rv_is_inside). Результат совпадает с перебором по возрастанию номеров.
+    \return Номер точки или SIZE_MAX.
+*/
+size_t rv_tree_find(const rv_tree_t *tree, const double *x);
+
+/*! Ищет любую точку, шар которой, расширенный на radius, содержит x
+    вместе с границей (rv_is_within). Поиск прекращается на первой
+    найденной точке.
+    \return Номер точки или SIZE_MAX.
+*/
+size_t rv_tree_any_within(const rv_tree_t *tree, const double *x,
+    double radius);
+
+/*! Ищет ближайшую к x точку (радиусы точек не учитываются) и считает
+    точки, шар которых, расширенный на radius, содержит x вместе
+    с границей. Оба результата получаются за один обход дерева.
+    \param count Количество точек в пределах radius.
+    \param dist Расстояние до ближайшей точки (rv_dist_ref).
+    \return Номер ближайшей точки или SIZE_MAX для пустого дерева.
+*/
+size_t rv_tree_nearest(const rv_tree_t *tree, const double *x,
+    double radius, size_t *count, double *dist);
+
+void rv_tree_free(rv_tree_t *tree);
+
+#endif
\ No newline at end of file
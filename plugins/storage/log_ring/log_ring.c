@@ -0,0 +1,187 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include <iam/plugin.h>
+#include <iam/logger.h>
+#include <iam/setting.h>
+#include <stdio.h>
+#include <string.h>
+#include "log_ring.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define ring_fetch_add(p) \
+        ((uint64_t)_InterlockedExchangeAdd64((volatile __int64 *)(p), 1))
+    #define ring_store(p, v) (MemoryBarrier(), *(volatile uint64_t *)(p) = (v))
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #define ring_fetch_add(p) __atomic_fetch_add(p, 1, __ATOMIC_RELAXED)
+    #define ring_store(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#endif
+
+#define FILENAME "log_ring.bin"
+
+static iam_metadata_t info = {
+    .name = "log_ring",
+    .version = "0.1",
+    .description = "Saving binary logs in a memory-mapped ring file",
+    .author = "Alexander Sekunov"
+};
+
+static log_ring_header_t *ring = NULL;
+static size_t ring_size = 0;
+#ifdef _WIN32
+static HANDLE ring_file = INVALID_HANDLE_VALUE, ring_map = NULL;
+#endif
+
+static log_ring_record_t *record_at(log_ring_header_t *r, uint64_t n) {
+    return (log_ring_record_t *)((char *)(r + 1)
+        + (size_t)(n % r->count) * r->record_size);
+}
+
+// Вызывается из любых потоков: место резервируется одной атомарной
+// операцией, запись становится видимой после записи seq. Если за время
+// записи кольцо успело пройти круг, запись может оказаться смешанной.
+// log_ring_read отбрасывает записи с выходящими за место полями или без
+// нулей в конце строк, а iam_logger_format_bin заменяет на '?' аргументы,
+// тип которых не подходит к преобразованию.
+static void save(const iam_log_bin_t *log) {
+    log_ring_header_t *r = ring;
+    log_ring_record_t *rec;
+    char *data;
+    size_t name_len, fmt_len, args_size, room;
+    uint64_t n;
+    if (r == NULL)
+        return;
+    n = ring_fetch_add(&r->next);
+    rec = record_at(r, n);
+    // Прерванная запись не должна выглядеть как старая завершённая
+    ring_store(&rec->seq, 0);
+    room = r->record_size - sizeof(*rec);
+    name_len = strlen(log->id->info->name);
+    if (name_len > room / 4)
+        name_len = room / 4;
+    room -= name_len + 1;
+    fmt_len = strlen(log->fmt);
+    if (fmt_len > room - 1)
+        fmt_len = room - 1;
+    room -= fmt_len + 1;
+    args_size = log->size < room ? log->size : room;
+    data = (char *)(rec + 1);
+    memcpy(data, log->id->info->name, name_len);
+    data[name_len] = '\0';
+    data += name_len + 1;
+    memcpy(data, log->fmt, fmt_len);
+    data[fmt_len] = '\0';
+    memcpy(data + fmt_len + 1, log->args, args_size);
+    rec->time = (int64_t)log->time;
+    rec->ns = log->ns;
+    rec->level = (uint32_t)log->level;
+    rec->name_len = (uint16_t)name_len;
+    rec->fmt_len = (uint16_t)fmt_len;
+    rec->args_size = (uint32_t)args_size;
+    ring_store(&rec->seq, n + 1);
+}
+
+iam_setting_t *fn;
+char filename[255] = FILENAME;
+uint32_t size_kb = 1024;
+uint32_t record_size = 256;
+
+static void ring_unmap(void) {
+    log_ring_header_t *r = ring;
+    if (r == NULL)
+        return;
+    ring = NULL;
+#ifdef _WIN32
+    FlushViewOfFile(r, 0);
+    UnmapViewOfFile(r);
+    CloseHandle(ring_map);
+    CloseHandle(ring_file);
+#else
+    msync(r, ring_size, MS_SYNC);
+    munmap(r, ring_size);
+#endif
+}
+
+static void *ring_map_file(size_t size) {
+#ifdef _WIN32
+    void *p;
+    ring_file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (ring_file == INVALID_HANDLE_VALUE)
+        return NULL;
+    ring_map = CreateFileMappingA(ring_file, NULL, PAGE_READWRITE,
+        (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+    if (ring_map == NULL) {
+        CloseHandle(ring_file);
+        return NULL;
+    }
+    p = MapViewOfFile(ring_map, FILE_MAP_WRITE, 0, 0, size);
+    if (p == NULL) {
+        CloseHandle(ring_map);
+        CloseHandle(ring_file);
+    }
+    return p;
+#else
+    void *p;
+    int fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return p != MAP_FAILED ? p : NULL;
+#endif
+}
+
+static void load_setting(iam_id_t id) {
+    // Записи выравниваются для атомарной записи seq
+    uint32_t rec_size = (record_size + 7) & ~(uint32_t)7;
+    uint32_t count = (uint32_t)(((size_t)size_kb * 1024
+        - sizeof(log_ring_header_t)) / rec_size);
+    log_ring_header_t *r;
+    ring_unmap();
+    ring_size = sizeof(log_ring_header_t) + (size_t)count * rec_size;
+    r = (log_ring_header_t *)ring_map_file(ring_size);
+    if (r == NULL) {
+        IAM_LOG_ERR("Failed to map the file \"%s\".", filename);
+        return;
+    }
+    // Записи файла с тем же устройством продолжаются, иначе он очищается
+    if (memcmp(r->magic, LOG_RING_MAGIC, 8) != 0
+            || r->record_size != rec_size || r->count != count) {
+        memset(r, 0, ring_size);
+        memcpy(r->magic, LOG_RING_MAGIC, 8);
+        r->record_size = rec_size;
+        r->count = count;
+    }
+    ring = r;
+}
+
+int log_ring_init(iam_id_t id) {
+    iam_setting_t *s;
+    fn = iam_setting_reg_str(id, "logfile", "Ring file name", filename, 255);
+    s = iam_setting_reg_uint32(id, "size_kb", "Ring file size in KiB.",
+        &size_kb);
+    iam_setting_set_range_uint32(s, 16, 4194304);
+    s = iam_setting_reg_uint32(id, "record_size", "Size of one record in "
+        "bytes; longer messages are truncated.", &record_size);
+    iam_setting_set_range_uint32(s, 128, 4096);
+    iam_setting_reg_callback(id, load_setting);
+    iam_logger_reg_save_bin(id, IAM_ALL, save);
+    return 0;
+}
+
+void log_ring_exit(iam_id_t id) {
+    ring_unmap();
+}
+
+IAM_PLUGIN_DYNAMIC_INIT(info, log_ring_init);
+IAM_PLUGIN_DYNAMIC_EXIT(log_ring_exit);
\ No newline at end of file
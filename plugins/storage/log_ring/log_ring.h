@@ -0,0 +1,35 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __LOG_RING_H__
+#define __LOG_RING_H__
+
+#include <stdint.h>
+
+#define LOG_RING_MAGIC "IAMRING1"
+
+// Заголовок файла. Записи следуют за ним: count записей по record_size
+// байт, запись с номером n хранится на месте n % count.
+typedef struct {
+    char magic[8];
+    uint32_t record_size;
+    uint32_t count;
+    uint64_t next;          // Номер следующей записи; резервируется атомарно
+    char reserved[40];
+} log_ring_header_t;
+
+// Запись: заголовок и за ним имя модуля, строка формата (обе с нулём) и
+// значения аргументов iam_log_bin_t. Не поместившиеся строка формата и
+// аргументы обрезаются.
+typedef struct {
+    uint64_t seq;           // Номер записи + 1, пишется последним (0 - нет)
+    int64_t time;
+    uint64_t ns;
+    uint32_t level;
+    uint16_t name_len;      // Длина имени без нуля
+    uint16_t fmt_len;       // Длина строки формата без нуля
+    uint32_t args_size;
+    uint32_t reserved;
+} log_ring_record_t;
+
+#endif
\ No newline at end of file
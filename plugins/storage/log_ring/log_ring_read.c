@@ -0,0 +1,93 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+// Выводит сообщения кольцевого файла log_ring в порядке записи:
+//     log_ring_read [file]
+#include <iam/logger.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log_ring.h"
+
+static const char *level_name(uint32_t level) {
+    switch (level) {
+        case IAM_ALL:   return "ALL";
+        case IAM_TRACE: return "TRACE";
+        case IAM_DEBUG: return "DEBUG";
+        case IAM_INFO:  return "INFO";
+        case IAM_WARN:  return "WARN";
+        case IAM_ERROR: return "ERROR";
+        case IAM_FATAL: return "FATAL";
+    }
+    return "None";
+}
+
+static int cmp_seq(const void *a, const void *b) {
+    uint64_t x = (*(const log_ring_record_t **)a)->seq;
+    uint64_t y = (*(const log_ring_record_t **)b)->seq;
+    return x < y ? -1 : x > y;
+}
+
+// true - запись завершена, лежит на своём месте и её строки завершены
+// нулём. Аргументы смешанной записи могут не подходить к строке формата;
+// такие аргументы iam_logger_format_bin заменяет на '?'.
+static int is_valid(const log_ring_header_t *h, const log_ring_record_t *rec,
+    size_t i) {
+    const char *p = (const char *)(rec + 1);
+    return rec->seq != 0 && (rec->seq - 1) % h->count == i
+        && sizeof(*rec) + rec->name_len + rec->fmt_len + 2 + rec->args_size
+            <= h->record_size
+        && p[rec->name_len] == '\0'
+        && p[rec->name_len + 1 + rec->fmt_len] == '\0';
+}
+
+int main(int argc, char **argv) {
+    const char *name = argc > 1 ? argv[1] : "log_ring.bin";
+    FILE *f = fopen(name, "rb");
+    log_ring_header_t h;
+    log_ring_record_t **recs;
+    iam_log_bin_t log;
+    char *data, *p, text[IAM_LOG_MAX_SIZE];
+    size_t i, n = 0;
+    if (f == NULL) {
+        fprintf(stderr, "Failed to open the file \"%s\".\n", name);
+        return 1;
+    }
+    if (fread(&h, sizeof(h), 1, f) != 1
+            || memcmp(h.magic, LOG_RING_MAGIC, 8) != 0
+            || h.record_size < sizeof(log_ring_record_t)) {
+        fprintf(stderr, "\"%s\" is not a log_ring file.\n", name);
+        fclose(f);
+        return 1;
+    }
+    data = (char *)malloc((size_t)h.count * h.record_size);
+    recs = (log_ring_record_t **)malloc(h.count * sizeof(*recs));
+    if (data == NULL || recs == NULL
+            || fread(data, h.record_size, h.count, f) != h.count) {
+        fprintf(stderr, "Failed to read the file \"%s\".\n", name);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+    for (i = 0; i < h.count; i++) {
+        recs[n] = (log_ring_record_t *)(data + i * h.record_size);
+        if (is_valid(&h, recs[n], i))
+            n++;
+    }
+    qsort(recs, n, sizeof(*recs), cmp_seq);
+    for (i = 0; i < n; i++) {
+        p = (char *)(recs[i] + 1);
+        log.time = (time_t)recs[i]->time;
+        log.ns = recs[i]->ns;
+        log.level = (iam_logger_level)recs[i]->level;
+        log.fmt = p + recs[i]->name_len + 1;
+        log.args = log.fmt + recs[i]->fmt_len + 1;
+        log.size = recs[i]->args_size;
+        iam_logger_format_bin(text, sizeof(text), &log);
+        printf("[%s] %s %s: %s\n", level_name(recs[i]->level),
+            iam_logger_time_str(log.time), p, text);
+    }
+    free(recs);
+    free(data);
+    return 0;
+}
\ No newline at end of file
@@ -5,40 +5,115 @@
 #include <iam/logger.h>
 #include <iam/setting.h>
 #include <stdio.h>
+#include <string.h>
+#include "writer.h"
 
 #define FILENAME "log.txt"
-FILE *f;
 
 static iam_metadata_t info = {
     .name = "log_txt",
-    .version = "0.1",
+    .version = "0.2",
     .description = "Saving logs in a txt file",
     .author = "Alexander Sekunov"
 };
 
+static const char *level_name(iam_logger_level level) {
+    switch (level) {
+        case IAM_ALL:   return "ALL";
+        case IAM_TRACE: return "TRACE";
+        case IAM_DEBUG: return "DEBUG";
+        case IAM_INFO:  return "INFO";
+        case IAM_WARN:  return "WARN";
+        case IAM_ERROR: return "ERROR";
+        case IAM_FATAL: return "FATAL";
+    }
+    return "None";
+}
+
 static void save(iam_log_t *log) {
-    fputs(log->msg, f);
-    fputc('\n', f);
+    char line[IAM_LOG_MAX_SIZE + 128];
+    int n = snprintf(line, sizeof(line), "[%s] %s %s: %s\n",
+        level_name(log->level), iam_logger_time_str(log->time),
+        log->id->info->name, log->msg);
+    if (n < 0)
+        return;
+    if ((size_t)n >= sizeof(line)) {
+        n = sizeof(line) - 1;
+        line[n - 1] = '\n';
+    }
+    txt_write(line, (size_t)n);
 }
 
 iam_setting_t *fn;
 char filename[255] = FILENAME;
+uint32_t buffer_kb = 256;
+uint32_t flush_ms = 1000;
+char fsync_mode[8] = "never";
+uint32_t rotate_mb = 0;
+uint32_t rotate_s = 0;
+uint32_t keep = 5;
+const char *fsync_sel[] = { "never", "flush", "rotate" };
+
+static iam_id_t plugin_id;
+
+// Вызывается потоком записи, когда файл после ротации не открылся
+static void report(const char *name, bool is_open, uint64_t lost) {
+    if (!is_open)
+        iam_logger_putf(plugin_id, IAM_ERROR, "Failed to reopen the file "
+            "\"%s\"; messages are kept in memory until it opens.", name);
+    else
+        iam_logger_putf(plugin_id, IAM_WARN, "The file \"%s\" is open "
+            "again; %llu messages were lost.", name,
+            (unsigned long long)lost);
+}
 
 static void load_setting(iam_id_t id) {
-    f = fopen(filename, "a");
-    if (f == NULL)
-        IAM_LOG_ERR("Failed to open the file \"s\".", filename);
+    txt_config_t cfg = {
+        .buf_size = (size_t)buffer_kb * 1024,
+        .flush_ms = flush_ms,
+        .fsync = TXT_FSYNC_NEVER,
+        .rotate_size = (uint64_t)rotate_mb * 1024 * 1024,
+        .rotate_time = rotate_s,
+        .keep = keep,
+        .report = report
+    };
+    if (strcmp(fsync_mode, "flush") == 0)
+        cfg.fsync = TXT_FSYNC_FLUSH;
+    else if (strcmp(fsync_mode, "rotate") == 0)
+        cfg.fsync = TXT_FSYNC_ROTATE;
+    if (txt_open(filename, &cfg))
+        IAM_LOG_ERR("Failed to open the file \"%s\".", filename);
 }
 
 int log_txt_init(iam_id_t id) {
+    iam_setting_t *s;
+    plugin_id = id;
     fn = iam_setting_reg_str(id, "logfile", "Log file name", filename, 255);
+    s = iam_setting_reg_uint32(id, "buffer_kb",
+        "Size of each of the write buffers in KiB.", &buffer_kb);
+    iam_setting_set_range_uint32(s, 4, 65536);
+    s = iam_setting_reg_uint32(id, "flush_ms", "Maximum delay before "
+        "buffered messages are written, in milliseconds.", &flush_ms);
+    iam_setting_set_range_uint32(s, 1, 3600000);
+    s = iam_setting_reg_str(id, "fsync", "When the file is synced to disk: "
+        "never, flush (after each write), rotate (before rotation).",
+        fsync_mode, sizeof(fsync_mode));
+    iam_setting_set_str_select(s, fsync_sel,
+        sizeof(fsync_sel) / sizeof(*fsync_sel));
+    iam_setting_reg_uint32(id, "rotate_mb",
+        "File size in MiB that starts a new file (0 - never).", &rotate_mb);
+    iam_setting_reg_uint32(id, "rotate_s",
+        "File age in seconds that starts a new file (0 - never).", &rotate_s);
+    s = iam_setting_reg_uint32(id, "keep",
+        "Number of old files kept as <logfile>.1, .2, ...", &keep);
+    iam_setting_set_range_uint32(s, 1, 1000);
     iam_setting_reg_callback(id, load_setting);
     iam_logger_reg_save(id, IAM_ALL, save);
     return 0;
 }
 
 void log_txt_exit(iam_id_t id) {
-    fclose(f);
+    txt_close();
 }
 
 IAM_PLUGIN_DYNAMIC_INIT(info, log_txt_init);
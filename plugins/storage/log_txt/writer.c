@@ -0,0 +1,361 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#include "writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <fcntl.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+    #include <process.h>
+    typedef CRITICAL_SECTION txt_mutex_t;
+    typedef CONDITION_VARIABLE txt_cond_t;
+    typedef HANDLE txt_thread_t;
+    #define txt_mutex_init(m) InitializeCriticalSection(m)
+    #define txt_mutex_destroy(m) DeleteCriticalSection(m)
+    #define txt_lock(m) EnterCriticalSection(m)
+    #define txt_unlock(m) LeaveCriticalSection(m)
+    #define txt_cond_init(c) InitializeConditionVariable(c)
+    #define txt_cond_destroy(c)
+    #define txt_wait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+    #define txt_timedwait(c, m, ms) SleepConditionVariableCS(c, m, ms)
+    #define txt_signal(c) WakeConditionVariable(c)
+    #define txt_broadcast(c) WakeAllConditionVariable(c)
+    #define TXT_OPEN_FLAGS (_O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY)
+    #define open(name, flags, mode) _open(name, flags, _S_IREAD | _S_IWRITE)
+    #define close _close
+    #define fsync(fd) _commit(fd)
+    #define lseek _lseeki64
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #include <sys/uio.h>
+    typedef pthread_mutex_t txt_mutex_t;
+    typedef pthread_cond_t txt_cond_t;
+    typedef pthread_t txt_thread_t;
+    #define txt_mutex_init(m) pthread_mutex_init(m, NULL)
+    #define txt_mutex_destroy(m) pthread_mutex_destroy(m)
+    #define txt_lock(m) pthread_mutex_lock(m)
+    #define txt_unlock(m) pthread_mutex_unlock(m)
+    #define txt_cond_init(c) pthread_cond_init(c, NULL)
+    #define txt_cond_destroy(c) pthread_cond_destroy(c)
+    #define txt_wait(c, m) pthread_cond_wait(c, m)
+    #define txt_signal(c) pthread_cond_signal(c)
+    #define txt_broadcast(c) pthread_cond_broadcast(c)
+    #define TXT_OPEN_FLAGS (O_WRONLY | O_CREAT | O_APPEND)
+#endif
+
+// Буферов на файл: один заполняется, остальные ждут записи
+#define TXT_BUF_N 4
+#define TXT_NAME_SIZE 272
+
+typedef struct {
+    char *data;
+    size_t used;
+} txt_buf_t;
+
+// Вызывающие потоки заполняют текущий буфер под блокировкой, полные
+// буферы записываются потоком записи одним вызовом writev без неё.
+static struct {
+    char filename[TXT_NAME_SIZE];
+    txt_config_t cfg;
+    txt_buf_t bufs[TXT_BUF_N];
+    txt_buf_t *cur;                 // Заполняемый буфер
+    txt_buf_t *full[TXT_BUF_N];     // Ожидают записи по порядку
+    txt_buf_t *free[TXT_BUF_N];
+    size_t full_n, free_n;
+    txt_mutex_t lock;
+    txt_cond_t wake;                // Есть полный буфер или остановка
+    txt_cond_t space;               // Буфер освободился
+    txt_thread_t thread;
+    int fd;
+    uint64_t size;                  // Размер текущего файла
+    time_t opened;                  // Время открытия текущего файла
+    uint64_t lost;                  // Сообщений, не принятых без файла
+    bool is_open;
+    bool is_stop;
+    bool is_failed;                 // Файл не удалось открыть заново
+} w = { .fd = -1 };
+
+#ifndef _WIN32
+static void txt_timedwait(txt_cond_t *c, txt_mutex_t *m, unsigned ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(c, m, &ts);
+}
+#endif
+
+static int txt_file_open(void) {
+    long long end;
+    w.fd = open(w.filename, TXT_OPEN_FLAGS, 0644);
+    if (w.fd < 0)
+        return 1;
+    end = (long long)lseek(w.fd, 0, SEEK_END);
+    w.size = end > 0 ? (uint64_t)end : 0;
+    w.opened = time(NULL);
+    return 0;
+}
+
+// Записывает буферы целиком, повторяя вызов после частичной записи
+static void txt_file_write(txt_buf_t **batch, size_t n) {
+    size_t i;
+#ifdef _WIN32
+    size_t pos;
+    int res;
+    for (i = 0; i < n; i++)
+        for (pos = 0; pos < batch[i]->used; pos += (size_t)res) {
+            res = _write(w.fd, batch[i]->data + pos,
+                (unsigned)(batch[i]->used - pos));
+            if (res <= 0)
+                return;
+            w.size += (uint64_t)res;
+        }
+#else
+    struct iovec iov[TXT_BUF_N];
+    struct iovec *p = iov;
+    ssize_t res;
+    for (i = 0; i < n; i++) {
+        iov[i].iov_base = batch[i]->data;
+        iov[i].iov_len = batch[i]->used;
+    }
+    while (n > 0) {
+        res = writev(w.fd, p, (int)n);
+        if (res <= 0)
+            return;
+        w.size += (uint64_t)res;
+        while (n > 0 && (size_t)res >= p->iov_len) {
+            res -= (ssize_t)p->iov_len;
+            p++;
+            n--;
+        }
+        if (n > 0) {
+            p->iov_base = (char *)p->iov_base + res;
+            p->iov_len -= (size_t)res;
+        }
+    }
+#endif
+}
+
+// Переименовывает файл в <filename>.1, сдвигая старые файлы
+static void txt_file_rotate(void) {
+    char from[TXT_NAME_SIZE + 12], to[TXT_NAME_SIZE + 12];
+    unsigned i;
+    if (w.cfg.fsync != TXT_FSYNC_NEVER)
+        fsync(w.fd);
+    close(w.fd);
+    for (i = w.cfg.keep; i > 1; i--) {
+        sprintf(from, "%s.%u", w.filename, i - 1);
+        sprintf(to, "%s.%u", w.filename, i);
+        remove(to);
+        rename(from, to);
+    }
+    sprintf(to, "%s.1", w.filename);
+    remove(to);
+    rename(w.filename, to);
+    txt_file_open();
+}
+
+static bool txt_is_rotate(void) {
+    return (w.cfg.rotate_size > 0 && w.size >= w.cfg.rotate_size)
+        || (w.cfg.rotate_time > 0
+            && (uint64_t)(time(NULL) - w.opened) >= w.cfg.rotate_time);
+}
+
+static void txt_main(void) {
+    txt_buf_t *batch[TXT_BUF_N];
+    size_t i, n;
+    uint64_t lost;
+    bool is_stop, was_failed = false;
+    txt_lock(&w.lock);
+    for (;;) {
+        // Без файла открытие повторяется раз в flush_ms
+        if ((w.full_n == 0 || w.fd < 0) && !w.is_stop)
+            txt_timedwait(&w.wake, &w.lock, w.cfg.flush_ms);
+        // Неполный буфер записывается вместе с полными
+        n = w.full_n;
+        memcpy(batch, w.full, n * sizeof(*batch));
+        w.full_n = 0;
+        if (w.cur->used > 0 && w.free_n > 0) {
+            batch[n++] = w.cur;
+            w.cur = w.free[--w.free_n];
+            w.cur->used = 0;
+        }
+        is_stop = w.is_stop;
+        txt_unlock(&w.lock);
+        if (w.fd < 0)
+            txt_file_open();
+        if (w.fd >= 0 && n > 0) {
+            txt_file_write(batch, n);
+            if (w.cfg.fsync == TXT_FSYNC_FLUSH)
+                fsync(w.fd);
+        }
+        if (w.fd >= 0 && txt_is_rotate())
+            txt_file_rotate();
+        txt_lock(&w.lock);
+        if (w.fd >= 0 || is_stop) {
+            // При остановке без файла данные записать уже некуда
+            for (i = 0; i < n; i++) {
+                batch[i]->used = 0;
+                w.free[w.free_n++] = batch[i];
+            }
+        } else {
+            // Незаписанные буферы старше остальных и остаются первыми
+            memmove(w.full + n, w.full, w.full_n * sizeof(*w.full));
+            memcpy(w.full, batch, n * sizeof(*batch));
+            w.full_n += n;
+        }
+        w.is_failed = w.fd < 0;
+        // Ожидающие места потоки перестают ждать, если файла нет
+        if (n > 0 || w.is_failed)
+            txt_broadcast(&w.space);
+        lost = 0;
+        if (!w.is_failed) {
+            lost = w.lost;
+            w.lost = 0;
+        }
+        // Сообщение о сбое может попасть в этот же файл, поэтому
+        // функция вызывается без блокировки
+        if (w.is_failed != was_failed) {
+            was_failed = w.is_failed;
+            if (w.cfg.report != NULL) {
+                txt_unlock(&w.lock);
+                w.cfg.report(w.filename, !was_failed, lost);
+                txt_lock(&w.lock);
+            }
+        }
+        if (is_stop && w.full_n == 0 && w.cur->used == 0)
+            break;
+    }
+    txt_unlock(&w.lock);
+}
+
+#ifdef _WIN32
+static unsigned __stdcall txt_thread_main(void *arg) {
+    txt_main();
+    return 0;
+}
+#else
+static void *txt_thread_main(void *arg) {
+    txt_main();
+    return NULL;
+}
+#endif
+
+static void txt_free_bufs(void) {
+    size_t i;
+    for (i = 0; i < TXT_BUF_N; i++) {
+        free(w.bufs[i].data);
+        w.bufs[i].data = NULL;
+    }
+}
+
+int txt_open(const char *filename, const txt_config_t *cfg) {
+    size_t i;
+    txt_close();
+    w.cfg = *cfg;
+    snprintf(w.filename, sizeof(w.filename), "%s", filename);
+    for (i = 0; i < TXT_BUF_N; i++) {
+        w.bufs[i].data = (char *)malloc(cfg->buf_size);
+        w.bufs[i].used = 0;
+        if (w.bufs[i].data == NULL) {
+            txt_free_bufs();
+            return 1;
+        }
+        w.free[i] = &w.bufs[TXT_BUF_N - 1 - i];
+    }
+    w.free_n = TXT_BUF_N - 1;
+    w.cur = &w.bufs[0];
+    w.full_n = 0;
+    w.lost = 0;
+    w.is_failed = false;
+    if (txt_file_open()) {
+        txt_free_bufs();
+        return 2;
+    }
+    w.is_stop = false;
+    txt_mutex_init(&w.lock);
+    txt_cond_init(&w.wake);
+    txt_cond_init(&w.space);
+#ifdef _WIN32
+    w.thread = (HANDLE)_beginthreadex(NULL, 0, txt_thread_main, NULL, 0,
+        NULL);
+    if (w.thread == 0) {
+#else
+    if (pthread_create(&w.thread, NULL, txt_thread_main, NULL) != 0) {
+#endif
+        txt_cond_destroy(&w.space);
+        txt_cond_destroy(&w.wake);
+        txt_mutex_destroy(&w.lock);
+        close(w.fd);
+        w.fd = -1;
+        txt_free_bufs();
+        return 3;
+    }
+    w.is_open = true;
+    return 0;
+}
+
+void txt_write(const char *line, size_t len) {
+    if (!w.is_open)
+        return;
+    if (len > w.cfg.buf_size)
+        len = w.cfg.buf_size;
+    txt_lock(&w.lock);
+    // Буфер отдаётся потоку записи только вместе с заменой, иначе другой
+    // поток увидел бы отданный буфер текущим
+    while (w.cur->used + len > w.cfg.buf_size && w.free_n == 0) {
+        // Пока файла нет, сообщение теряется, а вызывающий поток не ждёт
+        if (w.is_failed) {
+            w.lost++;
+            txt_unlock(&w.lock);
+            return;
+        }
+        txt_signal(&w.wake);
+        txt_wait(&w.space, &w.lock);
+    }
+    if (w.cur->used + len > w.cfg.buf_size) {
+        w.full[w.full_n++] = w.cur;
+        w.cur = w.free[--w.free_n];
+        txt_signal(&w.wake);
+    }
+    memcpy(w.cur->data + w.cur->used, line, len);
+    w.cur->used += len;
+    txt_unlock(&w.lock);
+}
+
+void txt_close(void) {
+    if (!w.is_open)
+        return;
+    txt_lock(&w.lock);
+    w.is_stop = true;
+    txt_signal(&w.wake);
+    txt_unlock(&w.lock);
+#ifdef _WIN32
+    WaitForSingleObject(w.thread, INFINITE);
+    CloseHandle(w.thread);
+#else
+    pthread_join(w.thread, NULL);
+#endif
+    w.is_open = false;
+    if (w.fd >= 0) {
+        if (w.cfg.fsync != TXT_FSYNC_NEVER)
+            fsync(w.fd);
+        close(w.fd);
+        w.fd = -1;
+    }
+    txt_cond_destroy(&w.space);
+    txt_cond_destroy(&w.wake);
+    txt_mutex_destroy(&w.lock);
+    txt_free_bufs();
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Copyright (c) 2024 Alexander Sekunov
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __LOG_TXT_WRITER_H__
+#define __LOG_TXT_WRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Когда данные принудительно сбрасываются на диск
+typedef enum {
+    TXT_FSYNC_NEVER,    // Решает операционная система
+    TXT_FSYNC_FLUSH,    // После каждой записи буферов
+    TXT_FSYNC_ROTATE    // Перед закрытием файла при ротации
+} txt_fsync_t;
+
+/*! Сообщает о состоянии файла; вызывается потоком записи.
+    \param is_open false - файл не удалось открыть заново, данные хранятся
+        в буферах и открытие повторяется; true - файл снова открыт.
+    \param lost Сообщений, не поместившихся в буферы, пока файла не было.
+*/
+typedef void (*txt_report_fn)(const char *filename, bool is_open,
+    uint64_t lost);
+
+typedef struct {
+    size_t buf_size;        // Размер одного буфера в байтах
+    unsigned flush_ms;      // Наибольшая задержка записи неполного буфера
+    txt_fsync_t fsync;
+    uint64_t rotate_size;   // Размер файла для ротации в байтах (0 - нет)
+    uint64_t rotate_time;   // Время жизни файла в секундах (0 - нет)
+    unsigned keep;          // Количество хранимых старых файлов
+    txt_report_fn report;   // NULL - не сообщать
+} txt_config_t;
+
+/*! Открывает файл для дозаписи и запускает поток записи.
+    \return 0 - успешно, 1 - не хватило памяти, 2 - не удалось открыть
+        файл, 3 - не удалось запустить поток.
+*/
+int txt_open(const char *filename, const txt_config_t *cfg);
+
+/*! Копирует строку в буфер. Вызывающий поток ждёт только тогда, когда
+    все буферы заполнены и ещё не записаны; ротация выполняется потоком
+    записи. Если файл не удалось открыть заново, строка, не поместившаяся
+    в буферы, теряется и учитывается в lost.
+*/
+void txt_write(const char *line, size_t len);
+
+// Записывает оставшиеся данные и закрывает файл
+void txt_close(void);
+
+#endif
\ No newline at end of file
@@ -2,6 +2,9 @@
 // License: http://opensource.org/licenses/MIT
 
 #include "algorithm_manager.h"
+#include "worker_pool.h"
+#include "hash.h"
+#include <iam/setting.h>
 #include <string.h>
 
 iam__list_t iam__binary_algs;
@@ -10,40 +13,202 @@ void iam__binary_algs_free(void *data);
 iam__list_t iam__real_algs;
 void iam__real_algs_free(void *data);
 
+// Экземпляры, не уничтоженные до iam_exit
+iam__list_t iam__binary_insts;
+void iam__binary_insts_free(void *data);
+
+iam__list_t iam__real_insts;
+void iam__real_insts_free(void *data);
+
+// Индексы алгоритмов по имени плагина (первый зарегистрированный)
+iam__hash_t iam__binary_index;
+iam__hash_t iam__real_index;
+
+// Размер части матрицы predict для одного потока, байт
+uint32_t iam__predict_chunk = 256 * 1024;
+
+typedef struct {
+    const iam_real_alg_t *alg;
+    void *ctx;              // Контекст экземпляра или NULL
+    const double *inX;
+    uint8_t *outY;
+    size_t row_n;
+    size_t col_n;
+    size_t chunk_n;
+} iam__predict_task_t;
+
 void iam__algorithm_manager_init(void) {
+    iam_setting_t *s;
     iam__list_init(&iam__binary_algs);
     iam__list_init(&iam__real_algs);
+    iam__list_init(&iam__binary_insts);
+    iam__list_init(&iam__real_insts);
+    iam__hash_init(&iam__binary_index);
+    iam__hash_init(&iam__real_index);
+    s = iam_setting_reg_uint32(iam__api, "predict_chunk",
+        "Size of the predict matrix part processed by one thread, bytes.",
+        &iam__predict_chunk);
+    iam_setting_set_range_uint32(s, 1, UINT32_MAX);
 }
 
 void iam__algorithm_manager_exit(void) {
+    // Экземпляры уничтожаются, пока плагины ещё загружены
+    iam__list_free_act(&iam__binary_insts, iam__binary_insts_free);
+    iam__list_free_act(&iam__real_insts, iam__real_insts_free);
     iam__list_free_act(&iam__binary_algs, iam__binary_algs_free);
     iam__list_free_act(&iam__real_algs, iam__real_algs_free);
+    iam__hash_free(&iam__binary_index);
+    iam__hash_free(&iam__real_index);
+}
+
+iam_binary_alg_t *iam_binary_alg_find(const char *alg_name) {
+    return (iam_binary_alg_t *)iam__hash_get(&iam__binary_index, alg_name);
+}
+
+iam_real_alg_t *iam_real_alg_find(const char *alg_name) {
+    return (iam_real_alg_t *)iam__hash_get(&iam__real_index, alg_name);
+}
+
+// Количество ненулевых результатов анализа
+static size_t iam__count_verdicts(const uint8_t *out, size_t n) {
+    size_t i, count = 0;
+    for (i = 0; i < n; i++)
+        count += out[i] != 0;
+    return count;
+}
+
+void iam_binary_alg_run_generate_batch(const iam_binary_alg_t *alg,
+    const char *const *data, const size_t *size, size_t n) {
+    iam_id_t id;
+    size_t i;
+    if (alg == NULL)
+        return;
+    id = IAM__ID(binary_alg, alg);
+    if (alg->generate_batch != NULL)
+        alg->generate_batch(id, data, size, n);
+    else if (alg->generate != NULL)
+        for (i = 0; i < n; i++)
+            alg->generate(id, data[i], size[i]);
+}
+
+size_t iam_binary_alg_run_analyze_batch(const iam_binary_alg_t *alg,
+    const char *const *data, const size_t *size, size_t n, uint8_t *out) {
+    iam_id_t id;
+    size_t i;
+    if (alg == NULL || (alg->analyze_batch == NULL && alg->analyze == NULL)) {
+        memset(out, 0, n);
+        return 0;
+    }
+    id = IAM__ID(binary_alg, alg);
+    if (alg->analyze_batch != NULL)
+        alg->analyze_batch(id, data, size, n, out);
+    else
+        for (i = 0; i < n; i++)
+            out[i] = alg->analyze(id, data[i], size[i]);
+    return iam__count_verdicts(out, n);
+}
+
+void iam_real_alg_run_generate_batch(const iam_real_alg_t *alg,
+    const double *vectors, size_t n, size_t k) {
+    iam_id_t id;
+    size_t i;
+    if (alg == NULL)
+        return;
+    id = IAM__ID(real_alg, alg);
+    if (alg->generate_batch != NULL)
+        alg->generate_batch(id, vectors, n, k);
+    else if (alg->generate != NULL)
+        for (i = 0; i < n; i++)
+            alg->generate(id, vectors + i * k, k);
+}
+
+size_t iam_real_alg_run_analyze_batch(const iam_real_alg_t *alg,
+    const double *vectors, size_t n, size_t k, uint8_t *out) {
+    iam_id_t id;
+    size_t i;
+    if (alg == NULL || (alg->analyze_batch == NULL && alg->analyze == NULL)) {
+        memset(out, 0, n);
+        return 0;
+    }
+    id = IAM__ID(real_alg, alg);
+    if (alg->analyze_batch != NULL)
+        alg->analyze_batch(id, vectors, n, k, out);
+    else
+        for (i = 0; i < n; i++)
+            out[i] = alg->analyze(id, vectors + i * k, k);
+    return iam__count_verdicts(out, n);
+}
+
+void iam_real_alg_run_fit(const iam_real_alg_t *alg,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
+    if (alg != NULL && alg->fit != NULL)
+        alg->fit(inX, inY, row_n, col_n);
 }
 
 void iam_real_alg_fit(const char *alg_name,
     const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
-    iam__node_t *p;
     iam__real_alg_t *alg;
-    IAM__FOREACH(p, iam__real_algs) {
-        alg = IAM__D(real_alg, p);
-        if (strcmp(alg_name, alg->id->info->name) == 0 
-            && alg->real.fit != NULL)
-            alg->real.fit(inX, inY, row_n, col_n);
+    alg = (iam__real_alg_t *)iam_real_alg_find(alg_name);
+    for (; alg != NULL; alg = alg->same)
+        iam_real_alg_run_fit(&alg->real, inX, inY, row_n, col_n);
+}
+
+static void iam__predict_task(void *ctx, size_t i) {
+    iam__predict_task_t *t = (iam__predict_task_t *)ctx;
+    size_t beg = i * t->chunk_n;
+    size_t n = t->row_n - beg < t->chunk_n ? t->row_n - beg : t->chunk_n;
+    if (t->ctx != NULL)
+        t->alg->predict_ctx(t->ctx, t->inX + beg * t->col_n, t->outY + beg,
+            n, t->col_n);
+    else
+        t->alg->predict(t->inX + beg * t->col_n, t->outY + beg, n, t->col_n);
+}
+
+static void iam__real_predict(const iam_real_alg_t *alg, void *ctx,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
+    iam__predict_task_t t = {
+        .alg = alg, .ctx = ctx, .inX = inX, .outY = outY, .row_n = row_n,
+        .col_n = col_n
+    };
+    if (!alg->is_parallel || iam__worker_pool_size() == 1 || col_n == 0) {
+        t.chunk_n = row_n;
+        iam__predict_task(&t, 0);
+        return;
     }
+    t.chunk_n = iam__predict_chunk / (col_n * sizeof(double));
+    if (t.chunk_n == 0)
+        t.chunk_n = 1;
+    iam__worker_pool_run((row_n + t.chunk_n - 1) / t.chunk_n,
+        iam__predict_task, &t);
+}
+
+void iam_real_alg_run_predict(const iam_real_alg_t *alg,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
+    if (alg != NULL && alg->predict != NULL)
+        iam__real_predict(alg, NULL, inX, outY, row_n, col_n);
 }
 
 void iam_real_alg_predict(const char *alg_name,
     const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
-    iam__node_t *p;
     iam__real_alg_t *alg;
-    IAM__FOREACH(p, iam__real_algs) {
-        alg = IAM__D(real_alg, p);
-        if (strcmp(alg_name, alg->id->info->name) == 0 
-            && alg->real.predict != NULL)
-            alg->real.predict(inX, outY, row_n, col_n);
-    }
+    alg = (iam__real_alg_t *)iam_real_alg_find(alg_name);
+    for (; alg != NULL; alg = alg->same)
+        iam_real_alg_run_predict(&alg->real, inX, outY, row_n, col_n);
 }
 
+// Добавляет алгоритм в индекс или в конец цепочки алгоритмов с тем же именем
+#define IAM__INDEX_ALG(type, index, alg) do {                          \
+    IAM__T(type) *first = (IAM__T(type) *)iam__hash_get(&index,       \
+        alg->id->info->name);                                           \
+    if (first == NULL) {                                                \
+        res = iam__hash_put(&index, alg->id->info->name, alg);         \
+    } else {                                                            \
+        while (first->same != NULL)                                     \
+            first = first->same;                                        \
+        first->same = alg;                                              \
+    }                                                                   \
+} while (0)
+
 iam_binary_alg_t *iam_algorithm_reg_binary(iam_id_t id) {
     int res;
     iam__binary_alg_t *alg = IAM__NEW(binary_alg);
@@ -52,11 +217,26 @@ iam_binary_alg_t *iam_algorithm_reg_binary(iam_id_t id) {
     alg->id = (iam__module_t *)id;
     alg->binary.analyze = NULL;
     alg->binary.generate = NULL;
+    alg->binary.create = NULL;
+    alg->binary.destroy = NULL;
+    alg->binary.generate_ctx = NULL;
+    alg->binary.analyze_ctx = NULL;
+    alg->binary.generate_batch = NULL;
+    alg->binary.analyze_batch = NULL;
+    alg->binary.generate_batch_ctx = NULL;
+    alg->binary.analyze_batch_ctx = NULL;
+    alg->same = NULL;
     iam__list_init(&alg->params);
     res = iam__list_append(&iam__binary_algs, alg);
     if (res == 1)
         return NULL;
-	iam_logger_puts(id, IAM_TRACE,
+    IAM__INDEX_ALG(binary_alg, iam__binary_index, alg);
+    if (res == 1) {
+        iam__list_remove(&iam__binary_algs, alg);
+        iam__free(alg);
+        return NULL;
+    }
+	IAM_LOG_PUTS(id, IAM_TRACE,
 		"Registered a binary algorithm");
     return (iam_binary_alg_t *)alg;
 }
@@ -69,11 +249,31 @@ iam_real_alg_t *iam_algorithm_reg_real(iam_id_t id) {
     alg->id = (iam__module_t *)id;
     alg->real.analyze = NULL;
     alg->real.generate = NULL;
+    alg->real.fit = NULL;
+    alg->real.predict = NULL;
+    alg->real.is_parallel = false;
+    alg->real.create = NULL;
+    alg->real.destroy = NULL;
+    alg->real.generate_ctx = NULL;
+    alg->real.analyze_ctx = NULL;
+    alg->real.fit_ctx = NULL;
+    alg->real.predict_ctx = NULL;
+    alg->real.generate_batch = NULL;
+    alg->real.analyze_batch = NULL;
+    alg->real.generate_batch_ctx = NULL;
+    alg->real.analyze_batch_ctx = NULL;
+    alg->same = NULL;
     iam__list_init(&alg->params);
     res = iam__list_append(&iam__real_algs, alg);
     if (res == 1)
         return NULL;
-	iam_logger_puts(id, IAM_TRACE,
+    IAM__INDEX_ALG(real_alg, iam__real_index, alg);
+    if (res == 1) {
+        iam__list_remove(&iam__real_algs, alg);
+        iam__free(alg);
+        return NULL;
+    }
+	IAM_LOG_PUTS(id, IAM_TRACE,
 		"Registered a real algorithm");
     return (iam_real_alg_t *)alg;
 }
@@ -81,47 +281,416 @@ iam_real_alg_t *iam_algorithm_reg_real(iam_id_t id) {
 void iam_binary_alg_reg_generate(iam_binary_alg_t *alg,
     iam_binary_generate_fn fn) {
     alg->generate = fn;
-	iam_logger_puts(IAM__ID(binary_alg, alg), IAM_TRACE,
+	IAM_LOG_PUTS(IAM__ID(binary_alg, alg), IAM_TRACE,
 		"Added generation function (binary)");  
 }
 
 void iam_binary_alg_reg_analyze(iam_binary_alg_t *alg,
     iam_binary_analyze_fn fn) {
     alg->analyze = fn;
-	iam_logger_puts(IAM__ID(binary_alg, alg), IAM_TRACE,
+	IAM_LOG_PUTS(IAM__ID(binary_alg, alg), IAM_TRACE,
 		"Added analysis function (binary)"); 
 }
 
 void iam_real_alg_reg_generate(iam_real_alg_t *alg,
     iam_real_generate_fn fn) {
     alg->generate = fn;
-	iam_logger_puts(IAM__ID(real_alg, alg), IAM_TRACE,
+	IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
 		"Added generation function (real)"); 
 }
 
 IAM_API void iam_real_alg_reg_analyze(iam_real_alg_t *alg,
     iam_real_analyze_fn fn) {
     alg->analyze = fn;
-	iam_logger_puts(IAM__ID(real_alg, alg), IAM_TRACE,
+	IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
 		"Added analysis function (real)"); 
 }
 
+void iam_binary_alg_reg_batch(iam_binary_alg_t *alg,
+    iam_binary_generate_batch_fn generate,
+    iam_binary_analyze_batch_fn analyze) {
+    if (generate != NULL)
+        alg->generate_batch = generate;
+    if (analyze != NULL)
+        alg->analyze_batch = analyze;
+    IAM_LOG_PUTS(IAM__ID(binary_alg, alg), IAM_TRACE,
+        "Added batch functions (binary)");
+}
+
+void iam_real_alg_reg_batch(iam_real_alg_t *alg,
+    iam_real_generate_batch_fn generate, iam_real_analyze_batch_fn analyze) {
+    if (generate != NULL)
+        alg->generate_batch = generate;
+    if (analyze != NULL)
+        alg->analyze_batch = analyze;
+    IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
+        "Added batch functions (real)");
+}
+
 void iam_real_alg_reg_fit(iam_real_alg_t *alg,
     iam_real_fit_fn fn) {
     alg->fit = fn;
-	iam_logger_puts(IAM__ID(real_alg, alg), IAM_TRACE,
+	IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
 		"Added fit function (real)"); 
 }
 
 void iam_real_alg_reg_predict(iam_real_alg_t *alg,
     iam_real_predict_fn fn) {
     alg->predict = fn;
-	iam_logger_puts(IAM__ID(real_alg, alg), IAM_TRACE,
+	IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
 		"Added predict function (real)");
 }
 
+void iam_real_alg_reg_parallel(iam_real_alg_t *alg, bool is_parallel) {
+    alg->is_parallel = is_parallel;
+	IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
+		is_parallel ? "Enabled parallel predict (real)"
+            : "Disabled parallel predict (real)");
+}
+
+void iam_binary_alg_reg_instance(iam_binary_alg_t *alg,
+    iam_instance_create_fn create, iam_instance_destroy_fn destroy) {
+    alg->create = create;
+    alg->destroy = destroy;
+	IAM_LOG_PUTS(IAM__ID(binary_alg, alg), IAM_TRACE,
+		"Added instance functions (binary)");
+}
+
+void iam_binary_alg_reg_ctx(iam_binary_alg_t *alg,
+    iam_binary_generate_ctx_fn generate, iam_binary_analyze_ctx_fn analyze) {
+    if (generate != NULL)
+        alg->generate_ctx = generate;
+    if (analyze != NULL)
+        alg->analyze_ctx = analyze;
+    IAM_LOG_PUTS(IAM__ID(binary_alg, alg), IAM_TRACE,
+        "Added context functions (binary)");
+}
+
+void iam_binary_alg_reg_batch_ctx(iam_binary_alg_t *alg,
+    iam_binary_generate_batch_ctx_fn generate,
+    iam_binary_analyze_batch_ctx_fn analyze) {
+    if (generate != NULL)
+        alg->generate_batch_ctx = generate;
+    if (analyze != NULL)
+        alg->analyze_batch_ctx = analyze;
+    IAM_LOG_PUTS(IAM__ID(binary_alg, alg), IAM_TRACE,
+        "Added batch context functions (binary)");
+}
+
+void iam_real_alg_reg_instance(iam_real_alg_t *alg,
+    iam_instance_create_fn create, iam_instance_destroy_fn destroy) {
+    alg->create = create;
+    alg->destroy = destroy;
+	IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
+		"Added instance functions (real)");
+}
+
+void iam_real_alg_reg_ctx(iam_real_alg_t *alg,
+    iam_real_generate_ctx_fn generate, iam_real_analyze_ctx_fn analyze,
+    iam_real_fit_ctx_fn fit, iam_real_predict_ctx_fn predict) {
+    if (generate != NULL)
+        alg->generate_ctx = generate;
+    if (analyze != NULL)
+        alg->analyze_ctx = analyze;
+    if (fit != NULL)
+        alg->fit_ctx = fit;
+    if (predict != NULL)
+        alg->predict_ctx = predict;
+    IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
+        "Added context functions (real)");
+}
+
+void iam_real_alg_reg_batch_ctx(iam_real_alg_t *alg,
+    iam_real_generate_batch_ctx_fn generate,
+    iam_real_analyze_batch_ctx_fn analyze) {
+    if (generate != NULL)
+        alg->generate_batch_ctx = generate;
+    if (analyze != NULL)
+        alg->analyze_batch_ctx = analyze;
+    IAM_LOG_PUTS(IAM__ID(real_alg, alg), IAM_TRACE,
+        "Added batch context functions (real)");
+}
+
+// Создаёт экземпляр алгоритма a (поле alg типа kind) и добавляет его
+// в список list. Без функции create экземпляр использует функции без
+// контекста.
+#define IAM__INST_CREATE(kind, list, a, name) do {                      \
+    IAM__T(kind##_inst) *inst;                                          \
+    void *ctx = NULL;                                                   \
+    if (a == NULL)                                                      \
+        return NULL;                                                    \
+    if (a->kind.create != NULL) {                                       \
+        ctx = a->kind.create((iam_id_t)a->id, name);                    \
+        if (ctx == NULL)                                                \
+            return NULL;                                                \
+    }                                                                   \
+    inst = IAM__NEW(kind##_inst);                                       \
+    if (inst != NULL && iam__list_append(&list, inst) == 1) {           \
+        iam__free(inst);                                                \
+        inst = NULL;                                                    \
+    }                                                                   \
+    if (inst == NULL) {                                                 \
+        if (ctx != NULL && a->kind.destroy != NULL)                     \
+            a->kind.destroy((iam_id_t)a->id, ctx);                      \
+        return NULL;                                                    \
+    }                                                                   \
+    inst->alg = a;                                                      \
+    inst->ctx = ctx;                                                    \
+    return inst;                                                        \
+} while (0)
+
+#define IAM__INST_DESTROY(kind, list, inst) do {                        \
+    if (inst == NULL)                                                   \
+        return;                                                         \
+    iam__list_remove(&list, inst);                                      \
+    iam__##kind##_insts_free(inst);                                     \
+    iam__free(inst);                                                    \
+} while (0)
+
+iam_binary_inst_t *iam_binary_inst_create(iam_binary_alg_t *alg,
+    const char *name) {
+    iam__binary_alg_t *a = (iam__binary_alg_t *)alg;
+    IAM__INST_CREATE(binary, iam__binary_insts, a, name);
+}
+
+void iam_binary_inst_destroy(iam_binary_inst_t *inst) {
+    IAM__INST_DESTROY(binary, iam__binary_insts, inst);
+}
+
+void iam_binary_inst_generate(iam_binary_inst_t *inst,
+    const char *data, size_t size) {
+    iam_binary_alg_t *alg;
+    if (inst == NULL)
+        return;
+    alg = &inst->alg->binary;
+    if (inst->ctx != NULL && alg->generate_ctx != NULL)
+        alg->generate_ctx(inst->ctx, data, size);
+    else if (inst->ctx == NULL && alg->generate != NULL)
+        alg->generate((iam_id_t)inst->alg->id, data, size);
+}
+
+bool iam_binary_inst_analyze(iam_binary_inst_t *inst,
+    const char *data, size_t size) {
+    iam_binary_alg_t *alg;
+    if (inst == NULL)
+        return false;
+    alg = &inst->alg->binary;
+    if (inst->ctx != NULL && alg->analyze_ctx != NULL)
+        return alg->analyze_ctx(inst->ctx, data, size);
+    if (inst->ctx == NULL && alg->analyze != NULL)
+        return alg->analyze((iam_id_t)inst->alg->id, data, size);
+    return false;
+}
+
+void iam_binary_inst_generate_batch(iam_binary_inst_t *inst,
+    const char *const *data, const size_t *size, size_t n) {
+    iam_binary_alg_t *alg;
+    size_t i;
+    if (inst == NULL)
+        return;
+    alg = &inst->alg->binary;
+    if (inst->ctx == NULL)
+        iam_binary_alg_run_generate_batch(alg, data, size, n);
+    else if (alg->generate_batch_ctx != NULL)
+        alg->generate_batch_ctx(inst->ctx, data, size, n);
+    else if (alg->generate_ctx != NULL)
+        for (i = 0; i < n; i++)
+            alg->generate_ctx(inst->ctx, data[i], size[i]);
+}
+
+size_t iam_binary_inst_analyze_batch(iam_binary_inst_t *inst,
+    const char *const *data, const size_t *size, size_t n, uint8_t *out) {
+    iam_binary_alg_t *alg;
+    size_t i;
+    if (inst == NULL)
+        return iam_binary_alg_run_analyze_batch(NULL, data, size, n, out);
+    alg = &inst->alg->binary;
+    if (inst->ctx == NULL)
+        return iam_binary_alg_run_analyze_batch(alg, data, size, n, out);
+    if (alg->analyze_batch_ctx != NULL)
+        alg->analyze_batch_ctx(inst->ctx, data, size, n, out);
+    else if (alg->analyze_ctx != NULL)
+        for (i = 0; i < n; i++)
+            out[i] = alg->analyze_ctx(inst->ctx, data[i], size[i]);
+    else
+        memset(out, 0, n);
+    return iam__count_verdicts(out, n);
+}
+
+iam_real_inst_t *iam_real_inst_create(iam_real_alg_t *alg,
+    const char *name) {
+    iam__real_alg_t *a = (iam__real_alg_t *)alg;
+    IAM__INST_CREATE(real, iam__real_insts, a, name);
+}
+
+void iam_real_inst_destroy(iam_real_inst_t *inst) {
+    IAM__INST_DESTROY(real, iam__real_insts, inst);
+}
+
+void iam_real_inst_generate(iam_real_inst_t *inst,
+    const double *vector, size_t k) {
+    iam_real_alg_t *alg;
+    if (inst == NULL)
+        return;
+    alg = &inst->alg->real;
+    if (inst->ctx != NULL && alg->generate_ctx != NULL)
+        alg->generate_ctx(inst->ctx, vector, k);
+    else if (inst->ctx == NULL && alg->generate != NULL)
+        alg->generate((iam_id_t)inst->alg->id, vector, k);
+}
+
+bool iam_real_inst_analyze(iam_real_inst_t *inst,
+    const double *vector, size_t k) {
+    iam_real_alg_t *alg;
+    if (inst == NULL)
+        return false;
+    alg = &inst->alg->real;
+    if (inst->ctx != NULL && alg->analyze_ctx != NULL)
+        return alg->analyze_ctx(inst->ctx, vector, k);
+    if (inst->ctx == NULL && alg->analyze != NULL)
+        return alg->analyze((iam_id_t)inst->alg->id, vector, k);
+    return false;
+}
+
+void iam_real_inst_generate_batch(iam_real_inst_t *inst,
+    const double *vectors, size_t n, size_t k) {
+    iam_real_alg_t *alg;
+    size_t i;
+    if (inst == NULL)
+        return;
+    alg = &inst->alg->real;
+    if (inst->ctx == NULL)
+        iam_real_alg_run_generate_batch(alg, vectors, n, k);
+    else if (alg->generate_batch_ctx != NULL)
+        alg->generate_batch_ctx(inst->ctx, vectors, n, k);
+    else if (alg->generate_ctx != NULL)
+        for (i = 0; i < n; i++)
+            alg->generate_ctx(inst->ctx, vectors + i * k, k);
+}
+
+size_t iam_real_inst_analyze_batch(iam_real_inst_t *inst,
+    const double *vectors, size_t n, size_t k, uint8_t *out) {
+    iam_real_alg_t *alg;
+    size_t i;
+    if (inst == NULL)
+        return iam_real_alg_run_analyze_batch(NULL, vectors, n, k, out);
+    alg = &inst->alg->real;
+    if (inst->ctx == NULL)
+        return iam_real_alg_run_analyze_batch(alg, vectors, n, k, out);
+    if (alg->analyze_batch_ctx != NULL)
+        alg->analyze_batch_ctx(inst->ctx, vectors, n, k, out);
+    else if (alg->analyze_ctx != NULL)
+        for (i = 0; i < n; i++)
+            out[i] = alg->analyze_ctx(inst->ctx, vectors + i * k, k);
+    else
+        memset(out, 0, n);
+    return iam__count_verdicts(out, n);
+}
+
+void iam_real_inst_fit(iam_real_inst_t *inst,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
+    iam_real_alg_t *alg;
+    if (inst == NULL)
+        return;
+    alg = &inst->alg->real;
+    if (inst->ctx != NULL && alg->fit_ctx != NULL)
+        alg->fit_ctx(inst->ctx, inX, inY, row_n, col_n);
+    else if (inst->ctx == NULL)
+        iam_real_alg_run_fit(alg, inX, inY, row_n, col_n);
+}
+
+void iam_real_inst_predict(iam_real_inst_t *inst,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
+    iam_real_alg_t *alg;
+    if (inst == NULL)
+        return;
+    alg = &inst->alg->real;
+    if (inst->ctx != NULL && alg->predict_ctx != NULL)
+        iam__real_predict(alg, inst->ctx, inX, outY, row_n, col_n);
+    else if (inst->ctx == NULL)
+        iam_real_alg_run_predict(alg, inX, outY, row_n, col_n);
+}
+
+// Аргументы асинхронного fit/predict
+typedef struct {
+    iam__real_alg_t *alg;       // Цепочка алгоритмов с одним именем
+    iam_real_inst_t *inst;      // Либо экземпляр
+    const double *inX;
+    const uint8_t *inY;
+    uint8_t *outY;
+    size_t row_n;
+    size_t col_n;
+} iam__real_job_t;
+
+static void iam__fit_job(void *ctx) {
+    iam__real_job_t *j = (iam__real_job_t *)ctx;
+    iam__real_alg_t *alg;
+    if (j->inst != NULL)
+        iam_real_inst_fit(j->inst, j->inX, j->inY, j->row_n, j->col_n);
+    for (alg = j->alg; alg != NULL; alg = alg->same)
+        iam_real_alg_run_fit(&alg->real, j->inX, j->inY, j->row_n, j->col_n);
+}
+
+static void iam__predict_job(void *ctx) {
+    iam__real_job_t *j = (iam__real_job_t *)ctx;
+    iam__real_alg_t *alg;
+    if (j->inst != NULL)
+        iam_real_inst_predict(j->inst, j->inX, j->outY, j->row_n, j->col_n);
+    for (alg = j->alg; alg != NULL; alg = alg->same)
+        iam_real_alg_run_predict(&alg->real, j->inX, j->outY, j->row_n,
+            j->col_n);
+}
+
+iam_job_t *iam_real_alg_fit_async(const char *alg_name,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
+    iam__real_job_t j = {
+        .alg = (iam__real_alg_t *)iam_real_alg_find(alg_name), .inst = NULL,
+        .inX = inX, .inY = inY, .outY = NULL, .row_n = row_n, .col_n = col_n
+    };
+    return iam__worker_pool_submit(iam__fit_job, &j, sizeof(j));
+}
+
+iam_job_t *iam_real_alg_predict_async(const char *alg_name,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
+    iam__real_job_t j = {
+        .alg = (iam__real_alg_t *)iam_real_alg_find(alg_name), .inst = NULL,
+        .inX = inX, .inY = NULL, .outY = outY, .row_n = row_n, .col_n = col_n
+    };
+    return iam__worker_pool_submit(iam__predict_job, &j, sizeof(j));
+}
+
+iam_job_t *iam_real_inst_fit_async(iam_real_inst_t *inst,
+    const double *inX, const uint8_t *inY, size_t row_n, size_t col_n) {
+    iam__real_job_t j = {
+        .alg = NULL, .inst = inst,
+        .inX = inX, .inY = inY, .outY = NULL, .row_n = row_n, .col_n = col_n
+    };
+    return iam__worker_pool_submit(iam__fit_job, &j, sizeof(j));
+}
+
+iam_job_t *iam_real_inst_predict_async(iam_real_inst_t *inst,
+    const double *inX, uint8_t *outY, size_t row_n, size_t col_n) {
+    iam__real_job_t j = {
+        .alg = NULL, .inst = inst,
+        .inX = inX, .inY = NULL, .outY = outY, .row_n = row_n, .col_n = col_n
+    };
+    return iam__worker_pool_submit(iam__predict_job, &j, sizeof(j));
+}
+
 void iam__binary_algs_free(void *data) {
 }
 
 void iam__real_algs_free(void *data) {
+}
+
+void iam__binary_insts_free(void *data) {
+    iam__binary_inst_t *inst = (iam__binary_inst_t *)data;
+    if (inst->ctx != NULL && inst->alg->binary.destroy != NULL)
+        inst->alg->binary.destroy((iam_id_t)inst->alg->id, inst->ctx);
+}
+
+void iam__real_insts_free(void *data) {
+    iam__real_inst_t *inst = (iam__real_inst_t *)data;
+    if (inst->ctx != NULL && inst->alg->real.destroy != NULL)
+        inst->alg->real.destroy((iam_id_t)inst->alg->id, inst->ctx);
 }
\ No newline at end of file
@@ -7,18 +7,37 @@
 #include <iam/algorithm.h>
 #include <common.h>
 
-typedef struct {
+typedef struct iam__binary_alg_s {
     iam_binary_alg_t binary;
     iam__module_t *id;
     iam__list_t params;
+    struct iam__binary_alg_s *same;  // Следующий алгоритм с тем же именем
 } iam__binary_alg_t;
 
-typedef struct {
+typedef struct iam__real_alg_s {
     iam_real_alg_t real;
     iam__module_t *id;
     iam__list_t params;
+    struct iam__real_alg_s *same;    // Следующий алгоритм с тем же именем
 } iam__real_alg_t;
 
+// Экземпляр алгоритма; ctx == NULL - функции без контекста
+struct iam_binary_inst_s {
+    iam__binary_alg_t *alg;
+    void *ctx;
+};
+
+struct iam_real_inst_s {
+    iam__real_alg_t *alg;
+    void *ctx;
+};
+
+typedef struct iam_binary_inst_s iam__binary_inst_t;
+typedef struct iam_real_inst_s iam__real_inst_t;
+
+// Размер части матрицы predict для одного потока, байт
+extern uint32_t iam__predict_chunk;
+
 void iam__algorithm_manager_init(void);
 void iam__algorithm_manager_exit(void);
 
@@ -7,6 +7,7 @@
 #include <iam/iam.h>
 #include <iam/logger.h>
 #include <list.h>
+#include <hash.h>
 
 extern iam_id_t iam__api;
 
@@ -14,6 +15,7 @@ typedef struct {
     const iam_metadata_t *info;
     iam__node_t *current_setting;
     iam__list_t settings;
+    iam__hash_t setting_index;  // Имя -> iam_setting_t *
     iam_exit_fn exit;
     iam_callback_fn setting_cb;
 } iam__module_t;
@@ -0,0 +1,194 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include <iam/dispatcher.h>
+#include "algorithm_manager.h"
+#include "worker_pool.h"
+#include <string.h>
+#include <stdint.h>
+
+typedef struct {
+    bool is_real;
+    void *inst;
+} iam__subscriber_t;
+
+struct iam_dispatcher_s {
+    iam_vote_t vote;
+    iam__subscriber_t *subs;
+    size_t sub_n;
+    size_t *voters;         // Номера голосующих: сначала последовательные
+    uint8_t *verdicts;      // Результаты голосующих [voter_n X n]
+    size_t verdict_size;
+};
+
+typedef struct {
+    const iam_dispatcher_t *d;
+    const iam_batch_t *batch;
+    size_t voter_n;
+    size_t serial_n;        // Голосующих, части которых разбираются по порядку
+    size_t chunk_n;         // Элементов пакета в одной части
+} iam__dispatch_task_t;
+
+iam_dispatcher_t *iam_dispatcher_create(iam_vote_t vote) {
+    iam_dispatcher_t *d = (iam_dispatcher_t *)iam__malloc(
+        sizeof(iam_dispatcher_t));
+    if (d == NULL)
+        return NULL;
+    d->vote = vote;
+    d->subs = NULL;
+    d->sub_n = 0;
+    d->voters = NULL;
+    d->verdicts = NULL;
+    d->verdict_size = 0;
+    return d;
+}
+
+void iam_dispatcher_destroy(iam_dispatcher_t *d) {
+    if (d == NULL)
+        return;
+    iam__free(d->subs);
+    iam__free(d->voters);
+    iam__free(d->verdicts);
+    iam__free(d);
+}
+
+static int iam__dispatcher_add(iam_dispatcher_t *d, bool is_real,
+    void *inst) {
+    iam__subscriber_t *subs;
+    size_t *voters;
+    subs = (iam__subscriber_t *)iam__realloc(d->subs,
+        sizeof(iam__subscriber_t) * (d->sub_n + 1));
+    if (subs == NULL)
+        return 1;
+    d->subs = subs;
+    voters = (size_t *)iam__realloc(d->voters,
+        sizeof(size_t) * (d->sub_n + 1));
+    if (voters == NULL)
+        return 1;
+    d->voters = voters;
+    d->subs[d->sub_n].is_real = is_real;
+    d->subs[d->sub_n].inst = inst;
+    d->sub_n++;
+    return 0;
+}
+
+int iam_dispatcher_add_real(iam_dispatcher_t *d, iam_real_inst_t *inst) {
+    return iam__dispatcher_add(d, true, inst);
+}
+
+int iam_dispatcher_add_binary(iam_dispatcher_t *d, iam_binary_inst_t *inst) {
+    return iam__dispatcher_add(d, false, inst);
+}
+
+// Части пакета одного голосующего можно разбирать одновременно, только если
+// это вещественный алгоритм, объявивший свою функцию потокобезопасной
+static bool iam__dispatch_is_parallel(const iam__subscriber_t *sub) {
+    return sub->is_real && sub->inst != NULL
+        && ((iam__real_inst_t *)sub->inst)->alg->real.is_parallel;
+}
+
+// Голосующий v разбирает часть пакета, начиная с элемента beg
+static void iam__dispatch_chunk_run(const iam__dispatch_task_t *t, size_t v,
+    size_t beg) {
+    const iam_batch_t *b = t->batch;
+    size_t n = b->n - beg < t->chunk_n ? b->n - beg : t->chunk_n;
+    const iam__subscriber_t *sub = &t->d->subs[t->d->voters[v]];
+    uint8_t *out = t->d->verdicts + v * b->n + beg;
+    if (sub->is_real)
+        iam_real_inst_analyze_batch((iam_real_inst_t *)sub->inst,
+            b->vectors + beg * b->k, n, b->k, out);
+    else
+        iam_binary_inst_analyze_batch((iam_binary_inst_t *)sub->inst,
+            b->data + beg, b->size + beg, n, out);
+}
+
+// Задача i < serial_n - последовательный голосующий i разбирает все части
+// по порядку; остальные задачи j = i - serial_n - параллельный голосующий
+// serial_n + j % parallel_n над частью j / parallel_n, поэтому потоки
+// одновременно разбирают одну часть пакета
+static void iam__dispatch_part(void *ctx, size_t i) {
+    iam__dispatch_task_t *t = (iam__dispatch_task_t *)ctx;
+    size_t beg, parallel_n = t->voter_n - t->serial_n;
+    if (i < t->serial_n) {
+        for (beg = 0; beg < t->batch->n; beg += t->chunk_n)
+            iam__dispatch_chunk_run(t, i, beg);
+        return;
+    }
+    i -= t->serial_n;
+    iam__dispatch_chunk_run(t, t->serial_n + i % parallel_n,
+        i / parallel_n * t->chunk_n);
+}
+
+// Размер части пакета по среднему размеру элемента
+static size_t iam__dispatch_chunk(const iam_batch_t *b) {
+    size_t i, total = 0, bytes = 0, chunk_n;
+    if (b->vectors != NULL)
+        bytes += b->k * sizeof(double);
+    if (b->data != NULL) {
+        for (i = 0; i < b->n; i++)
+            total += b->size[i];
+        bytes += total / b->n + sizeof(char *) + sizeof(size_t);
+    }
+    chunk_n = bytes > 0 ? iam__predict_chunk / bytes : b->n;
+    if (chunk_n > b->n)
+        chunk_n = b->n;
+    return chunk_n > 0 ? chunk_n : 1;
+}
+
+size_t iam_dispatcher_run(iam_dispatcher_t *d, const iam_batch_t *batch,
+    uint8_t *out) {
+    iam__dispatch_task_t t = { .d = d, .batch = batch, .voter_n = 0 };
+    size_t i, v, votes, pass, count = 0, n = batch->n;
+    uint8_t *verdicts;
+    // Последовательные голосующие идут первыми: их задачи самые длинные
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < d->sub_n; i++)
+            if ((d->subs[i].is_real ? batch->vectors != NULL
+                    : batch->data != NULL)
+                    && iam__dispatch_is_parallel(&d->subs[i]) == (pass == 1))
+                d->voters[t.voter_n++] = i;
+        if (pass == 0)
+            t.serial_n = t.voter_n;
+    }
+    if (t.voter_n == 0 || n == 0) {
+        memset(out, 0, n);
+        return 0;
+    }
+    if (n > SIZE_MAX / t.voter_n) {
+        iam_logger_puts(iam__api, IAM_ERROR, "Too large batch to dispatch.");
+        memset(out, 0, n);
+        return 0;
+    }
+    if (d->verdict_size < t.voter_n * n) {
+        verdicts = (uint8_t *)iam__realloc(d->verdicts, t.voter_n * n);
+        if (verdicts == NULL) {
+            iam_logger_puts(iam__api, IAM_ERROR,
+                "Not enough memory to dispatch a batch.");
+            memset(out, 0, n);
+            return 0;
+        }
+        d->verdicts = verdicts;
+        d->verdict_size = t.voter_n * n;
+    }
+    t.chunk_n = iam__dispatch_chunk(batch);
+    iam__worker_pool_run(t.serial_n
+        + ((n - 1) / t.chunk_n + 1) * (t.voter_n - t.serial_n),
+        iam__dispatch_part, &t);
+    for (i = 0; i < n; i++) {
+        votes = 0;
+        for (v = 0; v < t.voter_n; v++)
+            votes += d->verdicts[v * n + i] != 0;
+        switch (d->vote) {
+        case IAM_VOTE_ALL:
+            out[i] = votes == t.voter_n;
+            break;
+        case IAM_VOTE_MAJORITY:
+            out[i] = votes * 2 > t.voter_n;
+            break;
+        default:
+            out[i] = votes > 0;
+        }
+        count += out[i];
+    }
+    return count;
+}
\ No newline at end of file
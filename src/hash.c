@@ -0,0 +1,81 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include "hash.h"
+#include <string.h>
+
+#define IAM__HASH_MIN 16
+
+// FNV-1a
+uint64_t iam__hash_str(const char *str) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    while (*str) {
+        h ^= (uint8_t)*str++;
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+void iam__hash_init(iam__hash_t *hash) {
+    hash->slots = NULL;
+    hash->size = 0;
+    hash->count = 0;
+}
+
+static iam__hash_slot_t *iam__hash_find(iam__hash_slot_t *slots, size_t size,
+    const char *key) {
+    size_t mask = size - 1, i = (size_t)iam__hash_str(key) & mask;
+    while (slots[i].key != NULL && strcmp(slots[i].key, key) != 0)
+        i = (i + 1) & mask;
+    return &slots[i];
+}
+
+static int iam__hash_grow(iam__hash_t *hash) {
+    size_t i, size = hash->size ? hash->size * 2 : IAM__HASH_MIN;
+    iam__hash_slot_t *slots, *s;
+    slots = (iam__hash_slot_t *)iam__malloc(sizeof(*slots) * size);
+    if (slots == NULL)
+        return 1;
+    for (i = 0; i < size; i++) {
+        slots[i].key = NULL;
+        slots[i].data = NULL;
+    }
+    for (i = 0; i < hash->size; i++)
+        if (hash->slots[i].key != NULL) {
+            s = iam__hash_find(slots, size, hash->slots[i].key);
+            *s = hash->slots[i];
+        }
+    if (hash->slots != NULL)
+        iam__free(hash->slots);
+    hash->slots = slots;
+    hash->size = size;
+    return 0;
+}
+
+/*! Добавляет или заменяет значение ключа.
+    \return 0 - успешно, 1 - нехватка памяти.
+*/
+int iam__hash_put(iam__hash_t *hash, const char *key, void *data) {
+    iam__hash_slot_t *s;
+    // Заполнение не больше 3/4
+    if ((hash->count + 1) * 4 > hash->size * 3 && iam__hash_grow(hash))
+        return 1;
+    s = iam__hash_find(hash->slots, hash->size, key);
+    if (s->key == NULL) {
+        s->key = key;
+        hash->count++;
+    }
+    s->data = data;
+    return 0;
+}
+
+void *iam__hash_get(const iam__hash_t *hash, const char *key) {
+    if (hash->size == 0)
+        return NULL;
+    return iam__hash_find(hash->slots, hash->size, key)->data;
+}
+
+void iam__hash_free(iam__hash_t *hash) {
+    iam__free(hash->slots);
+    iam__hash_init(hash);
+}
\ No newline at end of file
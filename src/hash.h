@@ -0,0 +1,31 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __IAM_HASH_H__
+#define __IAM_HASH_H__
+
+#include <memory.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const char *key;    // Ключ не копируется и должен жить дольше таблицы
+    void *data;
+} iam__hash_slot_t;
+
+/*! Таблица строка -> указатель с открытой адресацией.
+*/
+typedef struct {
+    iam__hash_slot_t *slots;
+    size_t size;        // Количество ячеек (степень двойки) или 0
+    size_t count;
+} iam__hash_t;
+
+uint64_t iam__hash_str(const char *str);
+
+void iam__hash_init(iam__hash_t *hash);
+int iam__hash_put(iam__hash_t *hash, const char *key, void *data);
+void *iam__hash_get(const iam__hash_t *hash, const char *key);
+void iam__hash_free(iam__hash_t *hash);
+
+#endif
\ No newline at end of file
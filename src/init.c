@@ -6,6 +6,7 @@
 #include "setting_manager.h"
 #include "logger_manager.h"
 #include "plugin_manager.h"
+#include "worker_pool.h"
 #include "version.h"
 
 iam_metadata_t iam__api_md = {
@@ -21,17 +22,25 @@ iam_init_status iam_init(void) {
     iam_init_status res;
     iam__setting_manager_init();
     iam__logger_manager_init();
+    iam__logger_limit_init();
+    iam__logger_async_init();
+    iam__worker_pool_init();
     iam__algorithm_manager_init();
     res = iam__plugin_manager_init(IAM_PLUGINS_DIR);
     if (res)
         return res;
     iam__setting_manager_load();
+    iam__worker_pool_start();
     iam__logger_manager_flush();
+    iam__logger_async_start();
     return IAM_SUCCESS_INIT;
 }
 
 void iam_exit(void) {
+    iam__worker_pool_exit();
     iam__algorithm_manager_exit();
+    iam__logger_limit_exit();
+    iam__logger_async_exit();
     iam__logger_manager_exit();
     iam__setting_manager_exit();
     iam__plugin_manager_exit();
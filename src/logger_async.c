@@ -0,0 +1,289 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include "logger_manager.h"
+#include <iam/ring.h>
+#include <iam/setting.h>
+#include <os/os.h>
+#include <os/atomic.h>
+#include <stdio.h>
+#include <string.h>
+
+// Сообщений, передаваемых хранилищам за один проход потока записи
+#define IAM__LOG_BATCH 64
+// Поток записи просыпается сам не реже, чем раз в IAM__LOG_WAIT мс,
+// поэтому сообщения не будят его по одному
+#define IAM__LOG_WAIT 10
+
+// Текстовое сообщение (fmt == NULL) или двоичное: тогда msg содержит
+// size байт значений аргументов
+typedef struct {
+    iam_id_t id;
+    time_t time;
+    uint64_t ns;
+    iam_logger_level level;
+    const char *fmt;
+    size_t size;
+    char msg[IAM_LOG_MAX_SIZE];
+} iam__log_record_t;
+
+// Сообщения записываются в кольцевой буфер вызывающими потоками и
+// передаются хранилищам одним фоновым потоком, поэтому функции save
+// хранилищ вызываются последовательно.
+typedef struct {
+    iam_ring_t *ring;
+    iam__thread_t thread;
+    iam__mutex_t lock;
+    iam__cond_t wake;       // Появились сообщения или остановка
+    iam__cond_t space;      // Поток записи освободил место
+    uint64_t is_sleeping;   // Поток записи ожидает wake
+    uint64_t waiting;       // Потоков, ожидающих space
+    uint64_t dropped;       // Сообщений, не поместившихся в буфер
+    uint64_t is_open;       // Буфер принимает сообщения
+    uint64_t users;         // Потоков, записывающих в буфер
+    size_t wake_n;          // Заполнение, при котором поток записи будится
+    bool is_running;
+    bool is_stop;
+} iam__log_async_t;
+
+iam__log_async_t iam__log_async;
+bool iam__log_is_async = false;
+uint32_t iam__log_queue = 1024;
+// true - поток записи; его собственные сообщения сохраняются сразу
+IAM__THREAD_LOCAL bool iam__is_log_thread = false;
+
+// Записывает сообщение в буфер; false - буфер закрыт остановкой потока
+static bool iam__logger_async_push(const iam__log_record_t *rec) {
+    iam__log_async_t *a = &iam__log_async;
+    IAM__ADD(&a->users, 1);
+    IAM__FENCE();
+    // Указатель на функцию записи мог быть прочитан до остановки
+    if (!IAM__LOAD(&a->is_open)) {
+        IAM__SUB(&a->users, 1);
+        return false;
+    }
+    if (iam_ring_push(a->ring, rec, 1) == 0) {
+        // Ошибки не теряются: вызывающий поток ждёт освобождения места
+        if (rec->level < IAM_ERROR) {
+            IAM__ADD(&a->dropped, 1);
+            IAM__SUB(&a->users, 1);
+            return true;
+        }
+        iam__mutex_lock(&a->lock);
+        IAM__ADD(&a->waiting, 1);
+        IAM__FENCE();
+        while (iam_ring_push(a->ring, rec, 1) == 0) {
+            iam__cond_signal(&a->wake);
+            iam__cond_wait(&a->space, &a->lock);
+        }
+        IAM__SUB(&a->waiting, 1);
+        iam__mutex_unlock(&a->lock);
+    }
+    IAM__FENCE();
+    if (IAM__LOAD(&a->is_sleeping) && (rec->level >= IAM_ERROR
+            || iam_ring_count(a->ring) >= a->wake_n)) {
+        iam__mutex_lock(&a->lock);
+        iam__cond_signal(&a->wake);
+        iam__mutex_unlock(&a->lock);
+    }
+    IAM__SUB(&a->users, 1);
+    return true;
+}
+
+static void iam__logger_async_put(iam_id_t id, iam_logger_level level,
+    const char *msg) {
+    iam__log_record_t rec;
+    iam_log_t log;
+    size_t len;
+    if (iam__is_log_thread) {
+        log.id = id;
+        log.time = time(NULL);
+        log.ns = iam__clock_ns();
+        log.level = level;
+        log.msg = msg;
+        iam__logger_save(&log);
+        return;
+    }
+    len = strlen(msg);
+    if (len >= IAM_LOG_MAX_SIZE)
+        len = IAM_LOG_MAX_SIZE - 1;
+    rec.id = id;
+    rec.time = time(NULL);
+    rec.ns = iam__clock_ns();
+    rec.level = level;
+    rec.fmt = NULL;
+    memcpy(rec.msg, msg, len);
+    rec.msg[len] = '\0';
+    if (!iam__logger_async_push(&rec)) {
+        log.id = id;
+        log.time = rec.time;
+        log.ns = rec.ns;
+        log.level = level;
+        log.msg = msg;
+        iam__logger_save(&log);
+    }
+}
+
+static void iam__logger_async_put_bin(const iam_log_bin_t *log) {
+    iam__log_record_t rec;
+    if (iam__is_log_thread) {
+        iam__logger_save_bin(log);
+        return;
+    }
+    rec.id = log->id;
+    rec.time = log->time;
+    rec.ns = log->ns;
+    rec.level = log->level;
+    rec.fmt = log->fmt;
+    rec.size = log->size;
+    memcpy(rec.msg, log->args, log->size);
+    if (!iam__logger_async_push(&rec))
+        iam__logger_save_bin(log);
+}
+
+// Передаёт хранилищам одну непрерывную часть буфера
+static size_t iam__logger_async_drain(iam__log_async_t *a) {
+    size_t i, n;
+    iam_log_t log;
+    iam_log_bin_t bin;
+    const iam__log_record_t *rec = (const iam__log_record_t *)iam_ring_peek(
+        a->ring, IAM__LOG_BATCH, &n);
+    for (i = 0; i < n; i++) {
+        if (rec[i].fmt != NULL) {
+            bin.id = rec[i].id;
+            bin.time = rec[i].time;
+            bin.ns = rec[i].ns;
+            bin.level = rec[i].level;
+            bin.fmt = rec[i].fmt;
+            bin.args = rec[i].msg;
+            bin.size = rec[i].size;
+            iam__logger_save_bin(&bin);
+            continue;
+        }
+        log.id = rec[i].id;
+        log.time = rec[i].time;
+        log.ns = rec[i].ns;
+        log.level = rec[i].level;
+        log.msg = rec[i].msg;
+        iam__logger_save(&log);
+    }
+    iam_ring_release(a->ring, n);
+    IAM__FENCE();
+    if (n > 0 && IAM__LOAD(&a->waiting)) {
+        iam__mutex_lock(&a->lock);
+        iam__cond_broadcast(&a->space);
+        iam__mutex_unlock(&a->lock);
+    }
+    return n;
+}
+
+static void iam__logger_async_main(void *arg) {
+    iam__log_async_t *a = (iam__log_async_t *)arg;
+    uint64_t dropped = 0, cur;
+    iam_log_t log = { .id = iam__api, .level = IAM_WARN };
+    char msg[64];
+    iam__is_log_thread = true;
+    for (;;) {
+        if (iam__logger_async_drain(a) > 0)
+            continue;
+        cur = IAM__LOAD(&a->dropped);
+        if (cur != dropped) {
+            sprintf(msg, "Log queue is full, dropped messages: %llu.",
+                (unsigned long long)(cur - dropped));
+            dropped = cur;
+            log.time = time(NULL);
+            log.ns = iam__clock_ns();
+            log.msg = msg;
+            iam__logger_save(&log);
+        }
+        iam__mutex_lock(&a->lock);
+        IAM__STORE(&a->is_sleeping, 1);
+        IAM__FENCE();
+        // Буфер проверяется после is_sleeping, поэтому срочное сообщение,
+        // записанное до проверки, не ждёт окончания IAM__LOG_WAIT
+        if (iam_ring_count(a->ring) == 0) {
+            if (a->is_stop) {
+                iam__mutex_unlock(&a->lock);
+                break;
+            }
+            iam__cond_timedwait(&a->wake, &a->lock, IAM__LOG_WAIT);
+        }
+        IAM__STORE(&a->is_sleeping, 0);
+        iam__mutex_unlock(&a->lock);
+    }
+}
+
+void iam__logger_async_init(void) {
+    iam_setting_t *s;
+    memset(&iam__log_async, 0, sizeof(iam__log_async));
+    iam__mutex_init(&iam__log_async.lock);
+    iam__cond_init(&iam__log_async.wake);
+    iam__cond_init(&iam__log_async.space);
+    iam_setting_reg_bool(iam__api, "log_async",
+        "Save logs in a background thread.", &iam__log_is_async);
+    s = iam_setting_reg_uint32(iam__api, "log_queue",
+        "Number of log messages waiting for the background thread.",
+        &iam__log_queue);
+    iam_setting_set_range_uint32(s, 16, 1048576);
+}
+
+static void iam__logger_async_stop(void) {
+    iam__log_async_t *a = &iam__log_async;
+    if (!a->is_running)
+        return;
+    // Новые сообщения сохраняются сразу, а начатые дописываются в буфер
+    // до остановки потока, иначе они были бы потеряны
+    iam__log_writer = NULL;
+    iam__log_bin_writer = NULL;
+    IAM__STORE(&a->is_open, 0);
+    IAM__FENCE();
+    while (IAM__LOAD(&a->users) > 0) {
+        iam__mutex_lock(&a->lock);
+        iam__cond_timedwait(&a->space, &a->lock, 1);
+        iam__mutex_unlock(&a->lock);
+    }
+    iam__mutex_lock(&a->lock);
+    a->is_stop = true;
+    iam__cond_signal(&a->wake);
+    iam__mutex_unlock(&a->lock);
+    // Поток дописывает буфер перед завершением
+    iam__thread_join(&a->thread);
+    iam_ring_destroy(a->ring);
+    a->ring = NULL;
+    a->is_running = false;
+    a->is_stop = false;
+}
+
+void iam__logger_async_start(void) {
+    iam__log_async_t *a = &iam__log_async;
+    iam__logger_async_stop();
+    if (!iam__log_is_async)
+        return;
+    a->ring = iam_ring_create(iam__log_queue, sizeof(iam__log_record_t),
+        IAM_RING_MPSC);
+    a->wake_n = iam__log_queue / 4;
+    if (a->ring == NULL) {
+        iam_logger_puts(iam__api, IAM_ERROR,
+            "Not enough memory for the log queue.");
+        return;
+    }
+    if (iam__thread_start(&a->thread, iam__logger_async_main, a)) {
+        iam_ring_destroy(a->ring);
+        a->ring = NULL;
+        iam_logger_puts(iam__api, IAM_ERROR,
+            "Failed to start the log thread.");
+        return;
+    }
+    a->is_running = true;
+    IAM__STORE(&a->is_open, 1);
+    iam__log_writer = iam__logger_async_put;
+    iam__log_bin_writer = iam__logger_async_put_bin;
+    IAM_LOG_PUTS(iam__api, IAM_TRACE, "Started the log thread.");
+}
+
+void iam__logger_async_exit(void) {
+    iam__logger_async_stop();
+    iam__cond_destroy(&iam__log_async.space);
+    iam__cond_destroy(&iam__log_async.wake);
+    iam__mutex_destroy(&iam__log_async.lock);
+}
\ No newline at end of file
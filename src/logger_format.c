@@ -0,0 +1,363 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include "logger_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Аргумент в двоичном сообщении: байт типа и значение. Числа занимают
+// 8 байт без выравнивания, строка - 2 байта длины и символы без нуля.
+enum {
+    IAM__ARG_INT,
+    IAM__ARG_UINT,
+    IAM__ARG_DOUBLE,
+    IAM__ARG_PTR,
+    IAM__ARG_STR
+};
+
+// Наибольшая длина одного преобразования вместе с шириной и точностью
+#define IAM__SPEC_SIZE 32
+
+// Разобранное преобразование printf
+typedef struct {
+    const char *beg;    // Начало флагов (после '%')
+    const char *end;    // Символ преобразования
+    char length[3];     // Модификатор длины
+    bool is_width;      // Ширина задана '*'
+    bool is_prec;       // Точность задана '*'
+} iam__spec_t;
+
+// Разбирает преобразование, начинающееся после '%'
+static const char *iam__spec_parse(const char *p, iam__spec_t *spec) {
+    size_t n = 0;
+    spec->beg = p;
+    spec->is_width = spec->is_prec = false;
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL)
+        p++;
+    if (*p == '*') {
+        spec->is_width = true;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9')
+        p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->is_prec = true;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
+    while (*p != '\0' && strchr("hljztLq", *p) != NULL && n < 2)
+        spec->length[n++] = *p++;
+    spec->length[n] = '\0';
+    spec->end = p;
+    return *p != '\0' ? p + 1 : p;
+}
+
+static bool iam__arg_put(char **p, char *end, int type, const void *v,
+    size_t size) {
+    if (end - *p < (ptrdiff_t)(1 + size))
+        return false;
+    *(*p)++ = (char)type;
+    memcpy(*p, v, size);
+    *p += size;
+    return true;
+}
+
+static bool iam__arg_put_str(char **p, char *end, const char *str) {
+    size_t len = str != NULL ? strlen(str) : 6;
+    uint16_t n;
+    if (end - *p < 3)
+        return false;
+    if (len > (size_t)(end - *p) - 3)
+        len = (size_t)(end - *p) - 3;
+    n = (uint16_t)len;
+    *(*p)++ = IAM__ARG_STR;
+    memcpy(*p, &n, 2);
+    memcpy(*p + 2, str != NULL ? str : "(null)", len);
+    *p += 2 + len;
+    return true;
+}
+
+size_t iam__log_capture(char *out, size_t size, const char *fmt,
+    va_list ap) {
+    char *p = out, *end = out + size;
+    const char *f = fmt;
+    iam__spec_t spec;
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void *ptr;
+    bool is_ok = true;
+    while (is_ok && (f = strchr(f, '%')) != NULL) {
+        f = iam__spec_parse(f + 1, &spec);
+        if (spec.is_width) {
+            i = va_arg(ap, int);
+            is_ok = iam__arg_put(&p, end, IAM__ARG_INT, &i, 8);
+        }
+        if (is_ok && spec.is_prec) {
+            i = va_arg(ap, int);
+            is_ok = iam__arg_put(&p, end, IAM__ARG_INT, &i, 8);
+        }
+        if (!is_ok)
+            break;
+        switch (*spec.end) {
+        case 'd': case 'i':
+            if (strcmp(spec.length, "ll") == 0 || spec.length[0] == 'q')
+                i = va_arg(ap, long long);
+            else if (spec.length[0] == 'l')
+                i = va_arg(ap, long);
+            else if (spec.length[0] == 'j')
+                i = va_arg(ap, intmax_t);
+            else if (spec.length[0] == 'z')
+                i = (int64_t)va_arg(ap, size_t);
+            else if (spec.length[0] == 't')
+                i = va_arg(ap, ptrdiff_t);
+            else
+                i = va_arg(ap, int);
+            is_ok = iam__arg_put(&p, end, IAM__ARG_INT, &i, 8);
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            if (strcmp(spec.length, "ll") == 0 || spec.length[0] == 'q')
+                u = va_arg(ap, unsigned long long);
+            else if (spec.length[0] == 'l')
+                u = va_arg(ap, unsigned long);
+            else if (spec.length[0] == 'j')
+                u = va_arg(ap, uintmax_t);
+            else if (spec.length[0] == 'z')
+                u = va_arg(ap, size_t);
+            else if (spec.length[0] == 't')
+                u = (uint64_t)va_arg(ap, ptrdiff_t);
+            else
+                u = va_arg(ap, unsigned);
+            // hh и h приводятся при форматировании
+            is_ok = iam__arg_put(&p, end, IAM__ARG_UINT, &u, 8);
+            break;
+        case 'c':
+            i = va_arg(ap, int);
+            is_ok = iam__arg_put(&p, end, IAM__ARG_INT, &i, 8);
+            break;
+        case 'f': case 'F': case 'e': case 'E':
+        case 'g': case 'G': case 'a': case 'A':
+            if (spec.length[0] == 'L')
+                d = (double)va_arg(ap, long double);
+            else
+                d = va_arg(ap, double);
+            is_ok = iam__arg_put(&p, end, IAM__ARG_DOUBLE, &d, 8);
+            break;
+        case 's':
+            is_ok = iam__arg_put_str(&p, end, va_arg(ap, const char *));
+            break;
+        case 'p':
+            ptr = va_arg(ap, const void *);
+            is_ok = iam__arg_put(&p, end, IAM__ARG_PTR, &ptr, sizeof(ptr));
+            break;
+        case 'n':
+            // Запись количества символов не поддерживается
+            va_arg(ap, void *);
+            break;
+        }
+    }
+    return (size_t)(p - out);
+}
+
+size_t iam__log_capture_str(char *out, size_t size, const char *str) {
+    char *p = out;
+    iam__arg_put_str(&p, out + size, str);
+    return (size_t)(p - out);
+}
+
+// Читает следующий аргумент; false - аргументы закончились
+static bool iam__arg_get(const char **p, const char *end, int *type,
+    void *v, const char **str, uint16_t *len) {
+    if (*p >= end)
+        return false;
+    *type = (unsigned char)*(*p)++;
+    if (*type == IAM__ARG_STR) {
+        if (end - *p < 2)
+            return false;
+        memcpy(len, *p, 2);
+        *str = *p + 2;
+        *p += 2 + *len;
+        return *p <= end;
+    }
+    if (*type == IAM__ARG_PTR) {
+        if (end - *p < (ptrdiff_t)sizeof(void *))
+            return false;
+        memcpy(v, *p, sizeof(void *));
+        *p += sizeof(void *);
+        return true;
+    }
+    if (end - *p < 8)
+        return false;
+    memcpy(v, *p, 8);
+    *p += 8;
+    return true;
+}
+
+// Читает целый аргумент '*'. Значение ограничивается размером сообщения,
+// чтобы ширина из повреждённой записи не стала огромной.
+static bool iam__arg_get_int(const char **p, const char *end, int64_t *v) {
+    int type;
+    const char *str;
+    uint16_t len;
+    if (!iam__arg_get(p, end, &type, v, &str, &len) || type != IAM__ARG_INT)
+        return false;
+    if (*v > IAM_LOG_MAX_SIZE)
+        *v = IAM_LOG_MAX_SIZE;
+    else if (*v < -IAM_LOG_MAX_SIZE)
+        *v = -IAM_LOG_MAX_SIZE;
+    return true;
+}
+
+// Тип аргумента, который записывает iam__log_capture для преобразования,
+// или -1, если аргумент не записывается
+static int iam__spec_type(char conv) {
+    switch (conv) {
+    case 'd': case 'i': case 'c':
+        return IAM__ARG_INT;
+    case 'u': case 'o': case 'x': case 'X':
+        return IAM__ARG_UINT;
+    case 'f': case 'F': case 'e': case 'E':
+    case 'g': case 'G': case 'a': case 'A':
+        return IAM__ARG_DOUBLE;
+    case 's':
+        return IAM__ARG_STR;
+    case 'p':
+        return IAM__ARG_PTR;
+    }
+    return -1;
+}
+
+size_t iam_logger_format_bin(char *buf, size_t size,
+    const iam_log_bin_t *log) {
+    const char *f = log->fmt, *next, *a = (const char *)log->args;
+    const char *end = a + log->size, *str;
+    char spec_buf[IAM__SPEC_SIZE + 8], text[IAM_LOG_MAX_SIZE];
+    size_t pos = 0, n;
+    iam__spec_t spec;
+    int type, want, res = 0;
+    int64_t width = 0, prec = -1;
+    uint64_t v;
+    uint16_t len;
+    double d;
+    void *ptr;
+    if (size == 0)
+        return 0;
+    buf[0] = '\0';
+    while (*f != '\0' && pos < size - 1) {
+        next = strchr(f, '%');
+        n = next != NULL ? (size_t)(next - f) : strlen(f);
+        if (n > size - 1 - pos)
+            n = size - 1 - pos;
+        memcpy(buf + pos, f, n);
+        pos += n;
+        buf[pos] = '\0';
+        if (next == NULL || pos == size - 1)
+            break;
+        f = iam__spec_parse(next + 1, &spec);
+        if (*spec.end == '%') {
+            buf[pos++] = '%';
+            buf[pos] = '\0';
+            continue;
+        }
+        if ((spec.is_width && !iam__arg_get_int(&a, end, &width))
+                || (spec.is_prec && !iam__arg_get_int(&a, end, &prec)))
+            break;
+        if ((want = iam__spec_type(*spec.end)) < 0)
+            continue;
+        if (!iam__arg_get(&a, end, &type, &v, &str, &len))
+            break;
+        // Строка формата и аргументы могут быть из разных сообщений
+        // (например, в повреждённой записи), поэтому значение передаётся
+        // snprintf только с типом своего преобразования. Знак целого
+        // определяется преобразованием, иначе аргумент заменяется '?'.
+        if ((type == IAM__ARG_INT || type == IAM__ARG_UINT)
+                && (want == IAM__ARG_INT || want == IAM__ARG_UINT))
+            type = want;
+        else if (type != want) {
+            buf[pos++] = '?';
+            buf[pos] = '\0';
+            continue;
+        }
+        // Преобразование без модификатора длины; '*' заменяется значением
+        n = 0;
+        spec_buf[n++] = '%';
+        for (next = spec.beg; next < spec.end && n < IAM__SPEC_SIZE;
+                next++) {
+            if (*next == '*') {
+                if (next[-1] == '.')
+                    n += prec >= 0 ? sprintf(spec_buf + n, "%d", (int)prec)
+                        : 0;
+                else
+                    n += sprintf(spec_buf + n, "%d", (int)width);
+            } else if (strchr("hljztLq", *next) == NULL) {
+                spec_buf[n++] = *next;
+            }
+        }
+        // Точность '*' меньше нуля означает, что точность не задана
+        if (n > 1 && spec_buf[n - 1] == '.' && spec.is_prec && prec < 0)
+            n--;
+        switch (type) {
+        case IAM__ARG_INT:
+        case IAM__ARG_UINT:
+            if (*spec.end == 'c') {
+                spec_buf[n++] = 'c';
+                spec_buf[n] = '\0';
+                res = snprintf(buf + pos, size - pos, spec_buf,
+                    (int)(int64_t)v);
+                break;
+            }
+            // Значения hh и h приводятся к исходному типу
+            if (strcmp(spec.length, "hh") == 0)
+                v = type == IAM__ARG_INT ? (uint64_t)(int64_t)(signed char)v
+                    : (unsigned char)v;
+            else if (strcmp(spec.length, "h") == 0)
+                v = type == IAM__ARG_INT ? (uint64_t)(int64_t)(short)v
+                    : (unsigned short)v;
+            spec_buf[n++] = 'l';
+            spec_buf[n++] = 'l';
+            spec_buf[n++] = *spec.end;
+            spec_buf[n] = '\0';
+            if (type == IAM__ARG_INT)
+                res = snprintf(buf + pos, size - pos, spec_buf,
+                    (long long)(int64_t)v);
+            else
+                res = snprintf(buf + pos, size - pos, spec_buf,
+                    (unsigned long long)v);
+            break;
+        case IAM__ARG_DOUBLE:
+            memcpy(&d, &v, 8);
+            spec_buf[n++] = *spec.end;
+            spec_buf[n] = '\0';
+            res = snprintf(buf + pos, size - pos, spec_buf, d);
+            break;
+        case IAM__ARG_PTR:
+            memcpy(&ptr, &v, sizeof(ptr));
+            spec_buf[n++] = 'p';
+            spec_buf[n] = '\0';
+            res = snprintf(buf + pos, size - pos, spec_buf, ptr);
+            break;
+        case IAM__ARG_STR:
+            if (len >= sizeof(text))
+                len = sizeof(text) - 1;
+            memcpy(text, str, len);
+            text[len] = '\0';
+            spec_buf[n++] = 's';
+            spec_buf[n] = '\0';
+            res = snprintf(buf + pos, size - pos, spec_buf, text);
+            break;
+        default:
+            res = 0;
+        }
+        if (res < 0)
+            break;
+        pos += (size_t)res < size - pos ? (size_t)res : size - 1 - pos;
+    }
+    return pos;
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include "logger_manager.h"
+#include <iam/setting.h>
+#include <os/os.h>
+#include <os/atomic.h>
+
+// Частота ограничивается алгоритмом GCRA (эквивалент token bucket): в
+// limit->tat хранится время, когда запас сообщений станет полным, поэтому
+// состояние меняется одной операцией сравнения с обменом.
+uint32_t iam__log_rate = 10;    // Сообщений в секунду (0 - без ограничения)
+uint32_t iam__log_burst = 20;   // Сообщений подряд
+
+// Места вызова с пропусками. Место добавляется один раз, поэтому список
+// защищается простой блокировкой без инициализации.
+iam_log_limit_t *iam__log_limits = NULL;
+uint64_t iam__log_limits_lock = 0;
+
+static void iam__logger_limit_lock(void) {
+    uint64_t old = 0;
+    while (!IAM__CAS(&iam__log_limits_lock, &old, 1))
+        old = 0;
+}
+
+static void iam__logger_limit_unlock(void) {
+    IAM__STORE(&iam__log_limits_lock, 0);
+}
+
+static void iam__logger_limit_report(iam_id_t id, iam_logger_level level,
+    uint64_t skipped) {
+    iam_logger_putf(id, level, "Suppressed %llu similar messages.",
+        (unsigned long long)skipped);
+}
+
+void iam__logger_limit_init(void) {
+    iam_setting_t *s;
+    s = iam_setting_reg_uint32(iam__api, "log_rate", "Messages per second "
+        "from one place in the code that can repeat (0 - no limit).",
+        &iam__log_rate);
+    // Больше 1e9 шаг между сообщениями стал бы нулевым
+    iam_setting_set_range_uint32(s, 0, 1000000);
+    s = iam_setting_reg_uint32(iam__api, "log_burst",
+        "Messages in a row from one place before log_rate applies.",
+        &iam__log_burst);
+    iam_setting_set_range_uint32(s, 1, 1000000);
+}
+
+void iam__logger_limit_exit(void) {
+    iam_log_limit_t *limit, *next;
+    uint64_t skipped;
+    iam__logger_limit_lock();
+    limit = iam__log_limits;
+    iam__log_limits = NULL;
+    iam__logger_limit_unlock();
+    // Вывод без блокировки: хранилище само может ограничивать сообщения
+    for (; limit != NULL; limit = next) {
+        next = limit->next;
+        limit->next = NULL;
+        IAM__STORE(&limit->is_listed, 0);
+        skipped = IAM__XCHG(&limit->skipped, 0);
+        if (skipped > 0)
+            iam__logger_limit_report(limit->id, limit->level, skipped);
+    }
+}
+
+// Запоминает место вызова, чтобы вывести пропуски при iam_exit
+static void iam__logger_limit_list(iam_id_t id, iam_logger_level level,
+    iam_log_limit_t *limit) {
+    iam__logger_limit_lock();
+    if (limit->is_listed == 0) {
+        limit->id = id;
+        limit->level = level;
+        limit->next = iam__log_limits;
+        iam__log_limits = limit;
+        IAM__STORE(&limit->is_listed, 1);
+    }
+    iam__logger_limit_unlock();
+}
+
+bool iam_logger_limit(iam_id_t id, iam_logger_level level,
+    iam_log_limit_t *limit) {
+    uint64_t now, tat, next, step, skipped;
+    if (!iam_logger_is_on(level))
+        return false;
+    if (iam__log_rate == 0)
+        return true;
+    step = 1000000000u / iam__log_rate;
+    now = iam__clock_ns();
+    tat = IAM__LOAD(&limit->tat);
+    do {
+        if (tat >= now + step * iam__log_burst) {
+            IAM__ADD(&limit->skipped, 1);
+            if (IAM__LOAD(&limit->is_listed) == 0)
+                iam__logger_limit_list(id, level, limit);
+            return false;
+        }
+        next = (tat > now ? tat : now) + step;
+    } while (!IAM__CAS(&limit->tat, &tat, next));
+    skipped = IAM__XCHG(&limit->skipped, 0);
+    if (skipped > 0)
+        iam__logger_limit_report(id, level, skipped);
+    return true;
+}
\ No newline at end of file
@@ -2,36 +2,81 @@
 // License: http://opensource.org/licenses/MIT
 
 #include "logger_manager.h"
+#include <os/os.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
 
-iam__list_t iam__saved_logs;
-void iam__saved_logs_free(void *data);
+// Сообщения, накопленные до регистрации хранилищ, хранятся подряд в
+// статическом буфере: запись iam_log_t и за ней текст сообщения. Буфер
+// освобождается при сбросе накопленных сообщений в хранилища, поэтому
+// логирование не выделяет память.
+#define IAM__SAVED_LOGS_SIZE 65536
+#define IAM__SAVED_LOG_SIZE(len) \
+    ((sizeof(iam_log_t) + (len) + 1 + 7) & ~(size_t)7)
+
+union {
+    char data[IAM__SAVED_LOGS_SIZE];
+    iam_log_t align;
+} iam__saved_logs;
+size_t iam__saved_logs_used = 0;
+size_t iam__saved_logs_lost = 0;    // Не поместилось в буфер
 iam__list_t iam__log_stores;
-iam__list_t iam__bufs;
+iam__list_t iam__log_bin_stores;
 char is_accumulation = 0;
 iam_logger_level iam_logger_filter = IAM_LOG_LEVELS;
+iam__log_writer_fn iam__log_writer = NULL;
+iam__log_bin_writer_fn iam__log_bin_writer = NULL;
+// Уровни, которые нужны хотя бы одному хранилищу или консоли
+iam_logger_level iam__log_levels = 0;
+
+// true - сообщение уровня level кому-то нужно; проверяется до
+// форматирования
+#define IAM__LOG_IS_ON(level) (is_accumulation \
+    || (iam__log_levels & (level)) != 0)
+
+void iam__logger_update_levels(void) {
+    iam__node_t *p;
+    int levels = IAM_CONSOLE ? iam_logger_filter : 0;
+    if (iam__log_stores.count > 0)
+        IAM__FOREACH(p, iam__log_stores)
+            levels |= IAM__D(log_store, p)->filter;
+    if (iam__log_bin_stores.count > 0)
+        IAM__FOREACH(p, iam__log_bin_stores)
+            levels |= IAM__D(log_bin_store, p)->filter;
+    iam__log_levels = (iam_logger_level)levels;
+}
 
 void iam__logger_manager_init(void) {
     is_accumulation = 1;
-	iam__list_init(&iam__saved_logs);
+    iam__saved_logs_used = 0;
+    iam__saved_logs_lost = 0;
 	iam__list_init(&iam__log_stores);
+    iam__list_init(&iam__log_bin_stores);
+    iam__logger_update_levels();
 }
 
 void iam__logger_manager_exit(void) {
-	iam__list_free_act(&iam__saved_logs, iam__saved_logs_free);
+    iam__logger_manager_flush();
 	iam__list_free(&iam__log_stores);
-    iam__list_free(&iam__bufs);
+    iam__list_free(&iam__log_bin_stores);
+    iam__logger_update_levels();
 }
 
 static inline void iam__logger_put(iam_id_t id, iam_logger_level level,
     const char *msg);
 static inline void iam__logger_print(const iam_log_t *log);
+static void iam__logger_accumulate(const iam_log_t *log);
+static void iam__logger_store(const iam_log_t *log);
+static void iam__logger_store_text(const iam_log_t *log);
+
+bool iam_logger_is_on(iam_logger_level level) {
+    return IAM__LOG_IS_ON(level);
+}
 
 void iam_logger_puts(iam_id_t id, iam_logger_level level,
     const char *msg) {
-    if (is_accumulation || iam__log_stores.count > 0 || IAM_CONSOLE) {
+    if (IAM__LOG_IS_ON(level)) {
         iam__logger_put(id, level, msg);
     }
 }
@@ -39,21 +84,41 @@ void iam_logger_puts(iam_id_t id, iam_logger_level level,
 void iam_logger_putf(iam_id_t id, iam_logger_level level,
     const char *msg, ...) {
     va_list ap;
-    int len, res;
-    char buf[IAM_LOG_MAX_SIZE], *tmp;
-    if (is_accumulation || iam__log_stores.count > 0 || IAM_CONSOLE) {
+    char buf[IAM_LOG_MAX_SIZE];
+    if (IAM__LOG_IS_ON(level)) {
         va_start(ap, msg);
-        vsprintf(buf, msg, ap);
+        vsnprintf(buf, sizeof(buf), msg, ap);
         va_end(ap);
-        len = strlen(buf) + 1;
-        tmp = iam__malloc(len);
-        if (tmp == NULL)
-            return;
-        memcpy(tmp, buf, len);
-        res = iam__list_append(&iam__bufs, tmp);
-        if (res == 1)
-            return;
-        iam__logger_put(id, level, tmp);
+        // Сообщение копируется при накоплении или в очередь потока записи,
+        // иначе хранилища получают его до возврата
+        iam__logger_put(id, level, buf);
+    }
+}
+
+void iam_logger_putb(iam_id_t id, iam_logger_level level,
+    const char *fmt, ...) {
+    va_list ap;
+    char args[IAM_LOG_MAX_SIZE], buf[IAM_LOG_MAX_SIZE];
+    iam_log_bin_t log;
+    if (!IAM__LOG_IS_ON(level))
+        return;
+    va_start(ap, fmt);
+    log.size = iam__log_capture(args, sizeof(args), fmt, ap);
+    va_end(ap);
+    log.id = id;
+    log.time = time(NULL);
+    log.ns = iam__clock_ns();
+    log.level = level;
+    log.fmt = fmt;
+    log.args = args;
+    if (is_accumulation) {
+        // До регистрации хранилищ сообщение хранится текстом
+        iam_logger_format_bin(buf, sizeof(buf), &log);
+        iam__logger_put(id, level, buf);
+    } else if (iam__log_bin_writer != NULL) {
+        iam__log_bin_writer(&log);
+    } else {
+        iam__logger_save_bin(&log);
     }
 }
 
@@ -69,34 +134,144 @@ int iam_logger_reg_save(iam_id_t id, iam_logger_level filter,
     res = iam__list_append(&iam__log_stores, store);
     if (res == 1)
         return 2;
-	iam_logger_puts(id, IAM_TRACE,
+    iam__logger_update_levels();
+	IAM_LOG_PUTS(id, IAM_TRACE,
 		"Registered a function for saving logs");
     return 0;
 }
 
+int iam_logger_reg_save_bin(iam_id_t id, iam_logger_level filter,
+    iam_log_save_bin_fn save) {
+    iam__log_bin_store_t *store = IAM__NEW(log_bin_store);
+    if (store == NULL)
+        return 1;
+    store->id = (iam__module_t *)id;
+    store->filter = filter;
+    store->save = save;
+    if (iam__list_append(&iam__log_bin_stores, store) == 1)
+        return 2;
+    iam__logger_update_levels();
+	IAM_LOG_PUTS(id, IAM_TRACE,
+		"Registered a function for saving binary logs");
+    return 0;
+}
+
 void iam__logger_put(iam_id_t id, iam_logger_level level,
     const char *msg) {
-    iam__node_t *p;
-    iam_log_t *log = IAM_NEW(log);
-    if (log == NULL)
+    iam_log_t log;
+    if (!is_accumulation && iam__log_writer != NULL) {
+        iam__log_writer(id, level, msg);
         return;
-    log->id = id;
-    log->time = time(NULL);
-    log->level = level;
-    log->msg = msg;
-    if (IAM_CONSOLE && iam_logger_filter & level != 0)
-        iam__logger_print(log);
+    }
+    log.id = id;
+    log.time = time(NULL);
+    log.ns = iam__clock_ns();
+    log.level = level;
+    log.msg = msg;
     if (is_accumulation) {
-        iam__list_append(&iam__saved_logs, log);
+        if (IAM_CONSOLE && (iam_logger_filter & level) != 0)
+            iam__logger_print(&log);
+        iam__logger_accumulate(&log);
     } else {
-        IAM__FOREACH(p, iam__log_stores)
-            if (IAM__D(log_store, p)->filter & level != 0)
-                IAM__D(log_store, p)->save(log);
+        iam__logger_save(&log);
     }
 }
 
+// Копирует сообщение в буфер накопленных сообщений
+static void iam__logger_accumulate(const iam_log_t *log) {
+    size_t len = strlen(log->msg), size;
+    iam_log_t *rec;
+    if (len >= IAM_LOG_MAX_SIZE)
+        len = IAM_LOG_MAX_SIZE - 1;
+    size = IAM__SAVED_LOG_SIZE(len);
+    if (iam__saved_logs_used + size > IAM__SAVED_LOGS_SIZE) {
+        iam__saved_logs_lost++;
+        return;
+    }
+    rec = (iam_log_t *)(iam__saved_logs.data + iam__saved_logs_used);
+    *rec = *log;
+    rec->msg = (const char *)(rec + 1);
+    memcpy(rec + 1, log->msg, len);
+    ((char *)(rec + 1))[len] = '\0';
+    iam__saved_logs_used += size;
+}
+
+static void iam__logger_store_text(const iam_log_t *log) {
+    iam__node_t *p;
+    IAM__FOREACH(p, iam__log_stores)
+        if ((IAM__D(log_store, p)->filter & log->level) != 0)
+            IAM__D(log_store, p)->save((iam_log_t *)log);
+}
+
+static void iam__logger_store_bin(const iam_log_bin_t *log) {
+    iam__node_t *p;
+    IAM__FOREACH(p, iam__log_bin_stores)
+        if ((IAM__D(log_bin_store, p)->filter & log->level) != 0)
+            IAM__D(log_bin_store, p)->save(log);
+}
+
+// Передаёт текстовое сообщение всем хранилищам
+static void iam__logger_store(const iam_log_t *log) {
+    char args[IAM_LOG_MAX_SIZE];
+    iam_log_bin_t bin;
+    if (iam__log_stores.count > 0)
+        iam__logger_store_text(log);
+    if (iam__log_bin_stores.count > 0) {
+        bin.id = log->id;
+        bin.time = log->time;
+        bin.ns = log->ns;
+        bin.level = log->level;
+        bin.fmt = "%s";
+        bin.args = args;
+        bin.size = iam__log_capture_str(args, sizeof(args), log->msg);
+        iam__logger_store_bin(&bin);
+    }
+}
+
+void iam__logger_save(const iam_log_t *log) {
+    if (IAM_CONSOLE && (iam_logger_filter & log->level) != 0)
+        iam__logger_print(log);
+    iam__logger_store(log);
+}
+
+void iam__logger_save_bin(const iam_log_bin_t *log) {
+    char buf[IAM_LOG_MAX_SIZE];
+    iam_log_t text;
+    if (iam__log_bin_stores.count > 0)
+        iam__logger_store_bin(log);
+    // Текст формируется только для его получателей
+    if (iam__log_stores.count > 0 || IAM_CONSOLE) {
+        iam_logger_format_bin(buf, sizeof(buf), log);
+        text.id = log->id;
+        text.time = log->time;
+        text.ns = log->ns;
+        text.level = log->level;
+        text.msg = buf;
+        if (IAM_CONSOLE && (iam_logger_filter & log->level) != 0)
+            iam__logger_print(&text);
+        if (iam__log_stores.count > 0)
+            iam__logger_store_text(&text);
+    }
+}
+
+// Время последнего сформированного iam__time_str
+static IAM__THREAD_LOCAL time_t iam__time_last = (time_t)-1;
+static IAM__THREAD_LOCAL char iam__time_str[80];
+
+const char *iam_logger_time_str(time_t time) {
+    struct tm now;
+    if (time != iam__time_last) {
+        iam__localtime(time, &now);
+        snprintf(iam__time_str, sizeof(iam__time_str),
+            "%02d.%02d.%04d %02d:%02d:%02d",
+            now.tm_mday, now.tm_mon + 1, now.tm_year + 1900,
+            now.tm_hour, now.tm_min, now.tm_sec);
+        iam__time_last = time;
+    }
+    return iam__time_str;
+}
+
 void iam__logger_print(const iam_log_t *log) {
-    struct tm *now = localtime(&log->time);
     const char *type = "None";
     switch (log->level) {
         case IAM_ALL:   type="ALL";     break;
@@ -107,20 +282,23 @@ void iam__logger_print(const iam_log_t *log) {
         case IAM_ERROR: type="ERROR";   break;
         case IAM_FATAL: type="FATAL";
     }
-    printf("[%s] %02d.%02d.%04d %02d:%02d:%02d %s: %s\n", type,
-        now->tm_mday, now->tm_mon+1, now->tm_year+1900,
-        now->tm_hour, now->tm_min, now->tm_sec,
-        log->id->info->name, log->msg);        
-}
-
-void iam__saved_logs_free(void *data) {
-    iam__node_t *p;
-    iam_log_t *log = (iam_log_t *)data;
-    IAM__FOREACH(p, iam__log_stores)
-        if (IAM__D(log_store, p)->filter & log->level != 0)
-            IAM__D(log_store, p)->save(log);
+    printf("[%s] %s %s: %s\n", type, iam_logger_time_str(log->time),
+        log->id->info->name, log->msg);
 }
 
 void iam__logger_manager_flush(void) {
-    iam__list_free_act(&iam__saved_logs, iam__saved_logs_free);
+    size_t pos = 0, lost = iam__saved_logs_lost;
+    const iam_log_t *log;
+    while (pos < iam__saved_logs_used) {
+        log = (const iam_log_t *)(iam__saved_logs.data + pos);
+        iam__logger_store(log);
+        pos += IAM__SAVED_LOG_SIZE(strlen(log->msg));
+    }
+    iam__saved_logs_used = 0;
+    iam__saved_logs_lost = 0;
+    // Хранилища зарегистрированы, дальше сообщения сохраняются сразу
+    is_accumulation = 0;
+    if (lost > 0)
+        iam_logger_putf(iam__api, IAM_WARN,
+            "Log messages lost before saving was set up: %d.", (int)lost);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include <iam/logger.h>
 #include <common.h>
+#include <stdarg.h>
 
 #ifdef IAM_CONSOLE_LOG
     #define IAM_CONSOLE 1
@@ -19,8 +20,54 @@ typedef struct {
     iam_log_save_fn save;
 } iam__log_store_t;
 
+typedef struct {
+    iam__module_t *id;
+    iam_logger_level filter;
+    iam_log_save_bin_fn save;
+} iam__log_bin_store_t;
+
+/*! Передаёт сообщение фоновому потоку записи; сообщение копируется.
+*/
+typedef void (*iam__log_writer_fn)(iam_id_t id, iam_logger_level level,
+    const char *msg);
+
+/*! Передаёт двоичное сообщение фоновому потоку записи; аргументы
+    копируются.
+*/
+typedef void (*iam__log_bin_writer_fn)(const iam_log_bin_t *log);
+
+// Если заданы, сообщения после накопления передаются им, а не хранилищам
+extern iam__log_writer_fn iam__log_writer;
+extern iam__log_bin_writer_fn iam__log_bin_writer;
+
 void iam__logger_manager_init(void);
 void iam__logger_manager_exit(void);
 void iam__logger_manager_flush(void);
+/*! Пересчитывает уровни, нужные хранилищам; вызывается после изменения
+    списков хранилищ.
+*/
+void iam__logger_update_levels(void);
+
+/*! Выводит сообщение на консоль и передаёт его хранилищам.
+*/
+void iam__logger_save(const iam_log_t *log);
+void iam__logger_save_bin(const iam_log_bin_t *log);
+
+/*! Копирует значения аргументов по строке формата в двоичный вид.
+    \return Размер записанных данных; не поместившиеся аргументы
+        отбрасываются.
+*/
+size_t iam__log_capture(char *out, size_t size, const char *fmt,
+    va_list ap);
+// Записывает строку как единственный аргумент формата "%s"
+size_t iam__log_capture_str(char *out, size_t size, const char *str);
+
+void iam__logger_limit_init(void);
+// Выводит пропуски, после которых не было разрешённых сообщений
+void iam__logger_limit_exit(void);
+
+void iam__logger_async_init(void);
+void iam__logger_async_start(void);
+void iam__logger_async_exit(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __IAM_ATOMIC_H__
+#define __IAM_ATOMIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Атомарные операции над uint64_t: чтение с acquire, запись с release,
+// сложение и вычитание без упорядочивания, обмен и сравнение с обменом (при
+// неудаче old получает текущее значение). IAM__FENCE - полный барьер памяти.
+#ifdef _MSC_VER
+    #include <windows.h>
+    #include <intrin.h>
+    #define IAM__LOAD(p) (*(volatile uint64_t *)(p))
+    #define IAM__STORE(p, v) (*(volatile uint64_t *)(p) = (v))
+    #define IAM__ADD(p, v) _InterlockedExchangeAdd64( \
+        (volatile __int64 *)(p), (__int64)(v))
+    #define IAM__SUB(p, v) _InterlockedExchangeAdd64( \
+        (volatile __int64 *)(p), -(__int64)(v))
+    #define IAM__XCHG(p, v) ((uint64_t)_InterlockedExchange64( \
+        (volatile __int64 *)(p), (__int64)(v)))
+    #define IAM__FENCE() MemoryBarrier()
+    static inline bool iam__cas(uint64_t *p, uint64_t *old, uint64_t v) {
+        uint64_t cur = (uint64_t)_InterlockedCompareExchange64(
+            (volatile __int64 *)p, (__int64)v, (__int64)*old);
+        if (cur == *old)
+            return true;
+        *old = cur;
+        return false;
+    }
+    #define IAM__CAS(p, old, v) iam__cas(p, old, v)
+#else
+    #define IAM__LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+    #define IAM__STORE(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+    #define IAM__ADD(p, v) __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+    #define IAM__SUB(p, v) __atomic_fetch_sub(p, v, __ATOMIC_RELAXED)
+    #define IAM__XCHG(p, v) __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL)
+    #define IAM__FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+    #define IAM__CAS(p, old, v) __atomic_compare_exchange_n(p, old, v, \
+        true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif
+
+#endif
\ No newline at end of file
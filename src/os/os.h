@@ -5,6 +5,8 @@
 #define __IAM_OS_H__
 
 #include "iam/iam.h"
+#include <stdint.h>
+#include <time.h>
 #ifdef _WIN32
     #include "win.h"
 #else
@@ -24,4 +26,34 @@ const void *iam__lib_find(iam__lib_t *lib, const char *name);
 void iam__dir_close(iam__dir_t *dir);
 void iam__lib_close(iam__lib_t *lib);
 
+#ifdef _MSC_VER
+    #define IAM__THREAD_LOCAL __declspec(thread)
+#else
+    #define IAM__THREAD_LOCAL __thread
+#endif
+
+typedef void (*iam__thread_fn)(void *arg);
+
+int iam__thread_start(iam__thread_t *t, iam__thread_fn fn, void *arg);
+void iam__thread_join(iam__thread_t *t);
+unsigned iam__cpu_count(void);
+
+// Монотонное время в наносекундах от произвольного начала
+uint64_t iam__clock_ns(void);
+// Потокобезопасный localtime
+void iam__localtime(time_t time, struct tm *tm);
+
+void iam__mutex_init(iam__mutex_t *m);
+void iam__mutex_lock(iam__mutex_t *m);
+void iam__mutex_unlock(iam__mutex_t *m);
+void iam__mutex_destroy(iam__mutex_t *m);
+
+void iam__cond_init(iam__cond_t *c);
+void iam__cond_wait(iam__cond_t *c, iam__mutex_t *m);
+// Ожидает не дольше ms миллисекунд
+void iam__cond_timedwait(iam__cond_t *c, iam__mutex_t *m, unsigned ms);
+void iam__cond_signal(iam__cond_t *c);
+void iam__cond_broadcast(iam__cond_t *c);
+void iam__cond_destroy(iam__cond_t *c);
+
 #endif
\ No newline at end of file
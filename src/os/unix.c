@@ -2,6 +2,8 @@
 // License: http://opensource.org/licenses/MIT
 
 #include "os.h"
+#include <unistd.h>
+#include <time.h>
 
 iam__dir_t *iam__dir_open(const char *name) {
     return opendir(name);
@@ -36,4 +38,83 @@ void iam__dir_close(iam__dir_t *dir) {
 void iam__lib_close(iam__lib_t *lib) {
     if (lib)
         dlclose(lib);
+}
+
+static void *iam__thread_entry(void *arg) {
+    iam__thread_t *t = (iam__thread_t *)arg;
+    t->fn(t->arg);
+    return NULL;
+}
+
+int iam__thread_start(iam__thread_t *t, iam__thread_fn fn, void *arg) {
+    t->fn = fn;
+    t->arg = arg;
+    return pthread_create(&t->handle, NULL, iam__thread_entry, t);
+}
+
+void iam__thread_join(iam__thread_t *t) {
+    pthread_join(t->handle, NULL);
+}
+
+unsigned iam__cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+}
+
+uint64_t iam__clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void iam__localtime(time_t time, struct tm *tm) {
+    localtime_r(&time, tm);
+}
+
+void iam__mutex_init(iam__mutex_t *m) {
+    pthread_mutex_init(m, NULL);
+}
+
+void iam__mutex_lock(iam__mutex_t *m) {
+    pthread_mutex_lock(m);
+}
+
+void iam__mutex_unlock(iam__mutex_t *m) {
+    pthread_mutex_unlock(m);
+}
+
+void iam__mutex_destroy(iam__mutex_t *m) {
+    pthread_mutex_destroy(m);
+}
+
+void iam__cond_init(iam__cond_t *c) {
+    pthread_cond_init(c, NULL);
+}
+
+void iam__cond_wait(iam__cond_t *c, iam__mutex_t *m) {
+    pthread_cond_wait(c, m);
+}
+
+void iam__cond_timedwait(iam__cond_t *c, iam__mutex_t *m, unsigned ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    pthread_cond_timedwait(c, m, &ts);
+}
+
+void iam__cond_signal(iam__cond_t *c) {
+    pthread_cond_signal(c);
+}
+
+void iam__cond_broadcast(iam__cond_t *c) {
+    pthread_cond_broadcast(c);
+}
+
+void iam__cond_destroy(iam__cond_t *c) {
+    pthread_cond_destroy(c);
 }
\ No newline at end of file
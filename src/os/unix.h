@@ -8,9 +8,18 @@
 #include <dirent.h>
 #include <dlfcn.h>
 #include <errno.h>
+#include <pthread.h>
 
 typedef void iam__lib_t;
 typedef DIR iam__dir_t;
 typedef struct dirent iam__finfo_t;
 
+typedef struct {
+    pthread_t handle;
+    void (*fn)(void *);
+    void *arg;
+} iam__thread_t;
+typedef pthread_mutex_t iam__mutex_t;
+typedef pthread_cond_t iam__cond_t;
+
 #endif
\ No newline at end of file
@@ -61,4 +61,82 @@ void iam__dir_close(iam__dir_t *dir) {
 
 void iam__lib_close(iam__lib_t *lib) {
     FreeLibrary(lib);
+}
+
+static DWORD WINAPI iam__thread_entry(LPVOID arg) {
+    iam__thread_t *t = (iam__thread_t *)arg;
+    t->fn(t->arg);
+    return 0;
+}
+
+int iam__thread_start(iam__thread_t *t, iam__thread_fn fn, void *arg) {
+    t->fn = fn;
+    t->arg = arg;
+    t->handle = CreateThread(NULL, 0, iam__thread_entry, t, 0, NULL);
+    return t->handle == NULL;
+}
+
+void iam__thread_join(iam__thread_t *t) {
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+}
+
+unsigned iam__cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+uint64_t iam__clock_ns(void) {
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000u
+        + (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000u
+        / (uint64_t)freq.QuadPart;
+}
+
+void iam__localtime(time_t time, struct tm *tm) {
+    localtime_s(tm, &time);
+}
+
+void iam__mutex_init(iam__mutex_t *m) {
+    InitializeCriticalSection(m);
+}
+
+void iam__mutex_lock(iam__mutex_t *m) {
+    EnterCriticalSection(m);
+}
+
+void iam__mutex_unlock(iam__mutex_t *m) {
+    LeaveCriticalSection(m);
+}
+
+void iam__mutex_destroy(iam__mutex_t *m) {
+    DeleteCriticalSection(m);
+}
+
+void iam__cond_init(iam__cond_t *c) {
+    InitializeConditionVariable(c);
+}
+
+void iam__cond_wait(iam__cond_t *c, iam__mutex_t *m) {
+    SleepConditionVariableCS(c, m, INFINITE);
+}
+
+void iam__cond_timedwait(iam__cond_t *c, iam__mutex_t *m, unsigned ms) {
+    SleepConditionVariableCS(c, m, ms);
+}
+
+void iam__cond_signal(iam__cond_t *c) {
+    WakeConditionVariable(c);
+}
+
+void iam__cond_broadcast(iam__cond_t *c) {
+    WakeAllConditionVariable(c);
+}
+
+void iam__cond_destroy(iam__cond_t *c) {
 }
\ No newline at end of file
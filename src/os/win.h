@@ -14,4 +14,12 @@ typedef struct {
 } iam__dir_t;
 typedef WIN32_FIND_DATA iam__finfo_t;
 
+typedef struct {
+    HANDLE handle;
+    void (*fn)(void *);
+    void *arg;
+} iam__thread_t;
+typedef CRITICAL_SECTION iam__mutex_t;
+typedef CONDITION_VARIABLE iam__cond_t;
+
 #endif
\ No newline at end of file
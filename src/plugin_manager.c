@@ -39,12 +39,13 @@ iam__module_t *iam__plugin_register(iam_metadata_t *info, iam_exit_fn exit) {
 	plugin->info = info;
 	plugin->current_setting = NULL;
 	iam__list_init(&plugin->settings);
+	iam__hash_init(&plugin->setting_index);
 	plugin->exit = exit;
 	plugin->setting_cb = NULL;
     res = iam__list_append(&iam__plugins, plugin);
 	if (res == 1)
 		return NULL;
-	iam_logger_putf((iam_id_t)plugin, IAM_TRACE,
+	IAM_LOG_PUTF((iam_id_t)plugin, IAM_TRACE,
 		"Registered a plugin \"%s\" Ver. %s", info->name, info->version);
 	return plugin;
 }
@@ -60,7 +61,7 @@ iam_init_status iam__plugin_manager_search(const char *plugins_dir) {
 			"The directory \"%s\" was not found.", plugins_dir);
 		return IAM_PLUGIN_DIR_NOT_FOUND;
 	}
-	iam_logger_putf(iam__api, IAM_TRACE,
+	IAM_LOG_PUTF(iam__api, IAM_TRACE,
 		"Search for plugins in: \"%s\".", plugins_dir);
 	f = iam__dir_findfirst(dir);
 	while (f) {
@@ -77,7 +78,7 @@ iam_init_status iam__plugin_manager_search(const char *plugins_dir) {
 		}
 	}
 	iam__dir_close(dir);
-	iam_logger_putf(iam__api, IAM_TRACE,
+	IAM_LOG_PUTF(iam__api, IAM_TRACE,
 		"Plugins loaded: %d.", iam__plugins.count);
 	return IAM_SUCCESS_INIT;
 }
@@ -122,7 +123,7 @@ iam_init_status iam__plugin_manager_load(const char *name) {
 		iam__lib_close(lib);
 		return IAM_OUT_OF_MEMORY;
 	}
-	iam_logger_putf(iam__api, IAM_TRACE,
+	IAM_LOG_PUTF(iam__api, IAM_TRACE,
 		"Loaded: %s.", name);
 	return IAM_SUCCESS_INIT;
 }
@@ -130,6 +131,7 @@ iam_init_status iam__plugin_manager_load(const char *name) {
 void iam__plugins_free(void *data) {
 	iam__module_t *p = (iam__module_t *)data;
 	iam__list_free(&p->settings);
+	iam__hash_free(&p->setting_index);
 	if (p->exit != NULL)
 		p->exit((iam_id_t)p);
 }
@@ -0,0 +1,169 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include <iam/ring.h>
+#include <memory.h>
+#include <os/atomic.h>
+#include <string.h>
+
+#define IAM__CACHE_LINE 64
+
+// Позиции записи и чтения растут неограниченно, номер ячейки - позиция
+// по маске. Поля потоков записи и чтения лежат в разных кэш-линиях.
+struct iam_ring_s {
+    uint64_t tail;          // Следующая позиция записи
+    uint64_t head_cache;    // Последняя известная позиция чтения (SPSC)
+    uint64_t dropped;
+    char pad1[IAM__CACHE_LINE];
+    uint64_t head;          // Следующая позиция чтения
+    uint64_t peak;
+    char pad2[IAM__CACHE_LINE];
+    iam_ring_mode_t mode;
+    uint64_t mask;
+    size_t item_size;
+    uint8_t *items;         // Элементы [mask + 1 X item_size]
+    // MPSC: позиция + 1 последнего записанного в ячейку элемента, поэтому
+    // чтение видит элементы, запись которых уже завершена
+    uint64_t *seq;
+};
+
+iam_ring_t *iam_ring_create(size_t capacity, size_t item_size,
+    iam_ring_mode_t mode) {
+    iam_ring_t *r;
+    size_t size = 1;
+    if (capacity == 0 || item_size == 0 || capacity > SIZE_MAX / 2)
+        return NULL;
+    while (size < capacity)
+        size <<= 1;
+    if (size > SIZE_MAX / item_size)
+        return NULL;
+    r = (iam_ring_t *)iam__malloc(sizeof(iam_ring_t));
+    if (r == NULL)
+        return NULL;
+    memset(r, 0, sizeof(iam_ring_t));
+    r->mode = mode;
+    r->mask = size - 1;
+    r->item_size = item_size;
+    r->items = (uint8_t *)iam__malloc(size * item_size);
+    if (r->items == NULL) {
+        iam__free(r);
+        return NULL;
+    }
+    if (mode == IAM_RING_MPSC) {
+        r->seq = (uint64_t *)iam__malloc(size * sizeof(uint64_t));
+        if (r->seq == NULL) {
+            iam__free(r->items);
+            iam__free(r);
+            return NULL;
+        }
+        memset(r->seq, 0, size * sizeof(uint64_t));
+    }
+    return r;
+}
+
+void iam_ring_destroy(iam_ring_t *r) {
+    if (r == NULL)
+        return;
+    iam__free(r->seq);
+    iam__free(r->items);
+    iam__free(r);
+}
+
+// Копирует n элементов в ячейки, начиная с позиции pos
+static void iam__ring_write(iam_ring_t *r, uint64_t pos, const void *items,
+    size_t n) {
+    size_t beg = (size_t)(pos & r->mask);
+    size_t part = (size_t)(r->mask + 1) - beg;
+    if (part > n)
+        part = n;
+    memcpy(r->items + beg * r->item_size, items, part * r->item_size);
+    memcpy(r->items, (const uint8_t *)items + part * r->item_size,
+        (n - part) * r->item_size);
+}
+
+size_t iam_ring_push(iam_ring_t *r, const void *items, size_t n) {
+    uint64_t t, h, size = r->mask + 1, room, i, m;
+    if (n == 0)
+        return 0;
+    if (r->mode == IAM_RING_SPSC) {
+        t = r->tail;
+        room = size - (t - r->head_cache);
+        if (room < n) {
+            r->head_cache = IAM__LOAD(&r->head);
+            room = size - (t - r->head_cache);
+        }
+        m = n < room ? n : room;
+        iam__ring_write(r, t, items, (size_t)m);
+        IAM__STORE(&r->tail, t + m);
+    } else {
+        // Место занимается сдвигом tail, затем ячейки публикуются в seq
+        t = IAM__LOAD(&r->tail);
+        for (;;) {
+            h = IAM__LOAD(&r->head);
+            if (t - h > size) {
+                // t прочитана раньше, чем другие потоки сдвинули head
+                t = IAM__LOAD(&r->tail);
+                continue;
+            }
+            room = size - (t - h);
+            m = n < room ? n : room;
+            if (m == 0 || IAM__CAS(&r->tail, &t, t + m))
+                break;
+        }
+        iam__ring_write(r, t, items, (size_t)m);
+        for (i = 0; i < m; i++)
+            IAM__STORE(&r->seq[(t + i) & r->mask], t + i + 1);
+    }
+    if (m < n)
+        IAM__ADD(&r->dropped, n - m);
+    return (size_t)m;
+}
+
+const void *iam_ring_peek(iam_ring_t *r, size_t max, size_t *n) {
+    uint64_t h = r->head, t = IAM__LOAD(&r->tail), avail;
+    size_t beg = (size_t)(h & r->mask);
+    if (t - h > r->peak)
+        IAM__STORE(&r->peak, t - h);
+    avail = (r->mask + 1) - beg;
+    if (avail > t - h)
+        avail = t - h;
+    if (avail > max)
+        avail = max;
+    if (r->mode == IAM_RING_MPSC) {
+        // Занятые, но ещё не записанные ячейки прерывают часть
+        for (t = 0; t < avail; t++)
+            if (IAM__LOAD(&r->seq[beg + t]) != h + t + 1)
+                break;
+        avail = t;
+    }
+    *n = (size_t)avail;
+    return avail > 0 ? r->items + beg * r->item_size : NULL;
+}
+
+void iam_ring_release(iam_ring_t *r, size_t n) {
+    IAM__STORE(&r->head, r->head + n);
+}
+
+size_t iam_ring_pop(iam_ring_t *r, void *items, size_t max) {
+    size_t n, count = 0;
+    const void *p;
+    // Не больше двух частей: до конца буфера и от его начала
+    while (count < max && (p = iam_ring_peek(r, max - count, &n)) != NULL) {
+        memcpy((uint8_t *)items + count * r->item_size, p, n * r->item_size);
+        iam_ring_release(r, n);
+        count += n;
+    }
+    return count;
+}
+
+size_t iam_ring_count(iam_ring_t *r) {
+    uint64_t h = IAM__LOAD(&r->head);
+    return (size_t)(IAM__LOAD(&r->tail) - h);
+}
+
+void iam_ring_stats(iam_ring_t *r, iam_ring_stats_t *stats) {
+    stats->popped = IAM__LOAD(&r->head);
+    stats->pushed = IAM__LOAD(&r->tail);
+    stats->dropped = IAM__LOAD(&r->dropped);
+    stats->peak = IAM__LOAD(&r->peak);
+}
\ No newline at end of file
@@ -18,6 +18,11 @@ iam_setting_t *iam_setting_read(iam_id_t id) {
     return s;
 }
 
+iam_setting_t *iam_setting_find(iam_id_t id, const char *name) {
+    iam__module_t *module = (iam__module_t *)id;
+    return (iam_setting_t *)iam__hash_get(&module->setting_index, name);
+}
+
 const char *iam_setting_to_str(iam_setting_t *s) {
     return s->info->type->to_str(s->setting);
 }
@@ -39,6 +44,11 @@ iam_setting_t *iam_setting_reg(iam_variable_t *v, void *value) {
             s->setting = value;
             m = (iam__module_t *)s->info->id;
             res = iam__list_append(&m->settings, s);
+            // Пункт без индекса не должен остаться в списке
+            if (res == 0 && iam__hash_put(&m->setting_index, v->name, s)) {
+                iam__list_remove(&m->settings, s);
+                res = 1;
+            }
             if (res == 1) {
                 setting.status.init = IAM_OUT_OF_MEMORY;
                 return NULL;
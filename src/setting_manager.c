@@ -14,26 +14,32 @@ void iam__setting_manager_init(void) {
 
 void iam__setting_manager_exit(void) {
     iam__list_free(&iam__setting_stores);
+    iam__list_free(&((iam__module_t *)iam__api)->settings);
+    iam__hash_free(&((iam__module_t *)iam__api)->setting_index);
+}
+
+static void iam__setting_manager_load_module(iam_id_t id, iam_id_t module,
+    iam_setting_load_fn load) {
+    iam_callback_fn cb;
+    load(id, module);
+    cb = ((iam__module_t *)module)->setting_cb;
+    if (cb != NULL) {
+        cb(module);
+    }
 }
 
 void iam__setting_manager_load(void) {
-    iam_id_t id, module;
+    iam_id_t id;
     iam__node_t *p, *m;
-    iam_callback_fn cb;
     iam_setting_load_fn load;
     iam_setting_dump_fn dump;
     IAM__FOREACH(p, iam__setting_stores) {
         id = IAM_D(setting_store, p)->id;
         if ((load = IAM_D(setting_store, p)->load) == NULL)
             continue;
-        IAM__FOREACH(m, iam__plugins) {
-            module = *IAM_D(id, &m);
-            load(id, module);
-            cb = ((iam__module_t *)module)->setting_cb;
-            if (cb != NULL) {
-                cb(module);
-            }
-        }
+        iam__setting_manager_load_module(id, iam__api, load);
+        IAM__FOREACH(m, iam__plugins)
+            iam__setting_manager_load_module(id, *IAM_D(id, &m), load);
         if (dump = IAM_D(setting_store, p)->dump)
             dump(id);
     }
@@ -56,7 +62,7 @@ iam_setting_store_t *iam_setting_reg_store(iam_id_t id) {
     res = iam__list_append(&iam__setting_stores, store);
     if (res == 1)
         return NULL;
-	iam_logger_puts(id, IAM_TRACE,
+	IAM_LOG_PUTS(id, IAM_TRACE,
 		"Registered a setting store");
     return (iam_setting_store_t *)store;
 }
@@ -64,20 +70,20 @@ iam_setting_store_t *iam_setting_reg_store(iam_id_t id) {
 void iam_setting_store_reg_save(iam_setting_store_t *store,
     iam_setting_save_fn fn) {
     store->save = fn;
-	iam_logger_puts(store->id, IAM_TRACE,
+	IAM_LOG_PUTS(store->id, IAM_TRACE,
 		"Added save function (setting store)");
 }
 
 void iam_setting_store_reg_load(iam_setting_store_t *store,
     iam_setting_load_fn fn) {
     store->load = fn;
-	iam_logger_puts(store->id, IAM_TRACE,
+	IAM_LOG_PUTS(store->id, IAM_TRACE,
 		"Added load function (setting store)");  
 }
 
 void iam_setting_store_reg_dump(iam_setting_store_t *store,
     iam_setting_dump_fn fn) {
     store->dump = fn;
-	iam_logger_puts(store->id, IAM_TRACE,
+	IAM_LOG_PUTS(store->id, IAM_TRACE,
 		"Added dump function (setting store)");  
 }
\ No newline at end of file
@@ -86,7 +86,7 @@ iam_variable_t *iam_variable_reg(iam_class_t *c, iam_id_t id,
     iam_variable_t *v;
     if (ref == NULL && max == 1) {
         IAM__SET_STATUS(reg, IAM_SET_NULL);
-        iam_logger_putf(id, IAM_WARN, "Ignored value."
+        IAM_LOG_PUTF_LIMIT(id, IAM_WARN, "Ignored value."
             "The reference to the \"%s\" %s is not set. " 
             "The NULL value is available only for arrays.",
                 name, c->name);
@@ -107,6 +107,7 @@ iam_variable_t *iam_variable_reg(iam_class_t *c, iam_id_t id,
     v->num.is_spec_range = false;
     v->num.int_range.min = 0;
     v->num.int_range.max = 0;
+    memset(&v->limit, 0, sizeof(v->limit));
     if (ref == NULL) {
         ref = iam__malloc(size * max);
         if (ref == NULL) {
@@ -127,17 +128,24 @@ iam_variable_status iam__variable_warn_if_l0(iam_class_t *c, iam_variable_t *v,
     char *val) {
     iam_variable_status s = IAM_SET_NEGATIVE;
     IAM__SET_STATUS(set, s);
-    iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
-        "The %s \"%s\" cannot be negative (set %s).", c->name, v->name, val);
+    if (val != NULL)
+        iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+            "The %s \"%s\" cannot be negative (set %s).",
+            c->name, v->name, val);
     return s;
 }
 
+// Предупреждения каждой переменной ограничиваются по частоте отдельно;
+// значения форматируются, только если предупреждение будет выведено
+#define IAM__VAR_WARN_ON(v) iam_logger_limit((v)->id, IAM_WARN, &(v)->limit)
+
 #define IAM__VAR_IF_LESS_0(type, T, spec)           \
     iam_variable_status iam_variable_##type##_if_l0 \
         (iam_class_t *c, iam_variable_t *v, T val) {\
-        char buf[IAM__BS];                          \
-        sprintf(buf, spec, val);                    \
-        return iam__variable_warn_if_l0(c, v, buf); \
+        char buf[IAM__BS], *p = NULL;               \
+        if (IAM__VAR_WARN_ON(v))                    \
+            sprintf(p = buf, spec, val);            \
+        return iam__variable_warn_if_l0(c, v, p);   \
     }
 IAM__VAR_IF_LESS_0(int, int64_t, "%"PRId64)
 IAM__VAR_IF_LESS_0(uint, uint64_t, "%"PRIu64)
@@ -147,9 +155,10 @@ iam_variable_status iam__variable_warn_if_oor(iam_class_t *c, iam_variable_t *v,
     char *val, char *min, char *max) {
     iam_variable_status s = IAM_OUT_OF_RANGE;
     IAM__SET_STATUS(set, s);
-    iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
-        "The value for %s \"%s\" does not match the range [%s, %s] (set %s).",
-        c->name, v->name, min, max, val);
+    if (val != NULL)
+        iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+            "The value for %s \"%s\" does not match the range [%s, %s] "
+            "(set %s).", c->name, v->name, min, max, val);
     return s;
 }
 
@@ -159,6 +168,9 @@ iam_variable_status iam__variable_warn_if_oor(iam_class_t *c, iam_variable_t *v,
         char buf[3][IAM__BS];                       \
         T min = v->num.type##_range.min;            \
         T max = v->num.type##_range.max;            \
+        if (!IAM__VAR_WARN_ON(v))                   \
+            return iam__variable_warn_if_oor(c, v,  \
+                NULL, NULL, NULL);                  \
         sprintf(buf[0], spec, val);                 \
         sprintf(buf[1], spec, min);                 \
         sprintf(buf[2], spec, max);                 \
@@ -197,7 +209,7 @@ iam_variable_status iam_variable_check_str(iam_class_t *c, iam_variable_t *v,
             if (!v->str.is_set_null) {
                 s = IAM_SET_NULL;
                 IAM__SET_STATUS(set, s);
-                iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+                IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
                     "The value of %s \"%s\" cannot be set to NULL.",
                     c->name, v->name);
             }
@@ -211,7 +223,7 @@ iam_variable_status iam_variable_check_str(iam_class_t *c, iam_variable_t *v,
                 if (value_not_found) {
                     s = IAM_VALUE_NOT_FOUND;
                     IAM__SET_STATUS(set, s);
-                    iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+                    IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
                         "The string \"%s\" for %s \"%s\" was not found "
                         "in the given \"sel\".",
                         str, c->name, v->name);
@@ -222,7 +234,7 @@ iam_variable_status iam_variable_check_str(iam_class_t *c, iam_variable_t *v,
             if (size > v->size) {
                 s = IAM_OVERFLOW_VALUE;
                 IAM__SET_STATUS(set, s);
-                iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+                IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
                     "The string \"%s\" length with '\\0' ("PRIu64") exceeds "
                     "the allowed size ("PRIu64") for %s \"%s\".",
                     str, size, v->size, c->name, v->name);
@@ -237,7 +249,7 @@ iam_variable_status iam_variable_set_max(iam_class_t *c, iam_variable_t *v,
     if (max == 0) {
         s = IAM_SET_MAX_ERROR;
         IAM__SET_STATUS(set, s);
-        iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+        IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
             "The \"max\" value for %s \"%s\" variable must be greater than 0.",
             c->name, v->name);
         return s;
@@ -247,7 +259,7 @@ iam_variable_status iam_variable_set_max(iam_class_t *c, iam_variable_t *v,
     else if (max > v->max) {
         s = IAM_SET_MAX_ERROR;
         IAM__SET_STATUS(set, s);
-        iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+        IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
             "The \"max\" for %s \"%s\" is considered fixed.",
             c->name, v->name);
         return s;
@@ -259,7 +271,7 @@ iam_variable_status iam_variable_set_max(iam_class_t *c, iam_variable_t *v,
 iam_variable_status iam__variable_warn_if_ie(iam_class_t *c, iam_variable_t *v,
     size_t i, char *method, char* count_s, size_t count) {
     iam_variable_status s = IAM_INDEX_ERROR;
-    iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+    IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
         "Index "PRIu64" is outside the permissible range"
         "for %s \"%s\" (%s, %s = "PRIu64").",
         i, c->name, v->name, method, count_s, count);
@@ -313,7 +325,7 @@ void iam_variable_set_value(iam_class_t *c, iam_variable_t *v, char *method,
                     memcmp(memcpy(zero, val, rt->size), val, vt->size) == 0) {
                         memcpy(res, val, rt->size); 
                 } else {
-                    iam_logger_putf(v->id, IAM_WARN, "Ignored value. "
+                    IAM_LOG_PUTF_LIMIT(v->id, IAM_WARN, "Ignored value. "
                         "Value overflow detected at %s<-%s in "
                         "%s \"%s\" (%s %s)", rt->name, vt->name,
                         c->name, v->name, method, vt->to_str(val));
@@ -0,0 +1,301 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include "worker_pool.h"
+#include <iam/setting.h>
+#include <os/os.h>
+#include <string.h>
+
+typedef struct {
+    iam__thread_t *threads;
+    size_t count;
+    iam__mutex_t run_lock;  // Одновременно выполняется одна задача
+    iam__mutex_t lock;
+    iam__cond_t wake;
+    iam__cond_t done;
+    iam__task_fn fn;
+    void *ctx;
+    size_t next;
+    size_t total;
+    size_t finished;
+    bool is_stop;
+} iam__worker_pool_t;
+
+struct iam_job_s {
+    iam_job_fn fn;
+    void *ctx;
+    bool is_done;
+    struct iam_job_s *next;     // Следующее задание в очереди
+};
+
+// Потоки асинхронных заданий. Задание выполняется в потоке задания как
+// в вызывающем потоке, поэтому его части распределяются по пулу.
+typedef struct {
+    iam__thread_t *threads;
+    size_t count;
+    iam__mutex_t lock;
+    iam__cond_t wake;
+    iam__cond_t done;
+    iam_job_t *head;
+    iam_job_t *tail;
+    bool is_stop;
+} iam__job_pool_t;
+
+iam__worker_pool_t iam__pool;
+iam__job_pool_t iam__jobs;
+uint32_t iam__threads = 1;
+uint32_t iam__job_threads = 1;
+// true - поток выполняет часть задачи пула
+IAM__THREAD_LOCAL bool iam__is_task = false;
+
+// Выполняет части текущей задачи, пока они не закончатся (под lock)
+static void iam__worker_pool_drain(void) {
+    size_t i;
+    while (iam__pool.next < iam__pool.total) {
+        i = iam__pool.next++;
+        iam__mutex_unlock(&iam__pool.lock);
+        iam__is_task = true;
+        iam__pool.fn(iam__pool.ctx, i);
+        iam__is_task = false;
+        iam__mutex_lock(&iam__pool.lock);
+        if (++iam__pool.finished == iam__pool.total)
+            iam__cond_broadcast(&iam__pool.done);
+    }
+}
+
+static void iam__worker_main(void *arg) {
+    iam__mutex_lock(&iam__pool.lock);
+    while (!iam__pool.is_stop) {
+        iam__worker_pool_drain();
+        if (!iam__pool.is_stop)
+            iam__cond_wait(&iam__pool.wake, &iam__pool.lock);
+    }
+    iam__mutex_unlock(&iam__pool.lock);
+}
+
+static void iam__job_main(void *arg) {
+    iam_job_t *job;
+    iam__mutex_lock(&iam__jobs.lock);
+    for (;;) {
+        while (iam__jobs.head == NULL && !iam__jobs.is_stop)
+            iam__cond_wait(&iam__jobs.wake, &iam__jobs.lock);
+        // Перед остановкой очередь дорабатывается
+        if ((job = iam__jobs.head) == NULL)
+            break;
+        iam__jobs.head = job->next;
+        if (iam__jobs.head == NULL)
+            iam__jobs.tail = NULL;
+        iam__mutex_unlock(&iam__jobs.lock);
+        job->fn(job->ctx);
+        iam__mutex_lock(&iam__jobs.lock);
+        job->is_done = true;
+        iam__cond_broadcast(&iam__jobs.done);
+    }
+    iam__mutex_unlock(&iam__jobs.lock);
+}
+
+static void iam__job_pool_stop(void) {
+    size_t i;
+    iam__mutex_lock(&iam__jobs.lock);
+    iam__jobs.is_stop = true;
+    iam__cond_broadcast(&iam__jobs.wake);
+    iam__mutex_unlock(&iam__jobs.lock);
+    for (i = 0; i < iam__jobs.count; i++)
+        iam__thread_join(&iam__jobs.threads[i]);
+    iam__free(iam__jobs.threads);
+    iam__jobs.threads = NULL;
+    iam__jobs.count = 0;
+    iam__jobs.is_stop = false;
+}
+
+static void iam__job_pool_start(void) {
+    size_t i;
+    iam__job_pool_stop();
+    if (iam__job_threads == 0)
+        return;
+    iam__jobs.threads = (iam__thread_t *)iam__malloc(
+        sizeof(iam__thread_t) * iam__job_threads);
+    if (iam__jobs.threads == NULL) {
+        iam_logger_puts(iam__api, IAM_ERROR,
+            "Not enough memory to start job threads.");
+        return;
+    }
+    for (i = 0; i < iam__job_threads; i++) {
+        if (iam__thread_start(&iam__jobs.threads[i], iam__job_main, NULL))
+            break;
+        iam__jobs.count++;
+    }
+    IAM_LOG_PUTF(iam__api, IAM_TRACE,
+        "Started job threads: %d.", (int)iam__jobs.count);
+}
+
+static void iam__worker_pool_stop(void) {
+    size_t i;
+    iam__mutex_lock(&iam__pool.lock);
+    iam__pool.is_stop = true;
+    iam__cond_broadcast(&iam__pool.wake);
+    iam__mutex_unlock(&iam__pool.lock);
+    for (i = 0; i < iam__pool.count; i++)
+        iam__thread_join(&iam__pool.threads[i]);
+    iam__free(iam__pool.threads);
+    iam__pool.threads = NULL;
+    iam__pool.count = 0;
+    iam__pool.is_stop = false;
+}
+
+void iam__worker_pool_init(void) {
+    iam_setting_t *s;
+    iam__pool.threads = NULL;
+    iam__pool.count = 0;
+    iam__pool.total = iam__pool.next = iam__pool.finished = 0;
+    iam__pool.is_stop = false;
+    iam__mutex_init(&iam__pool.run_lock);
+    iam__mutex_init(&iam__pool.lock);
+    iam__cond_init(&iam__pool.wake);
+    iam__cond_init(&iam__pool.done);
+    iam__jobs.threads = NULL;
+    iam__jobs.count = 0;
+    iam__jobs.head = iam__jobs.tail = NULL;
+    iam__jobs.is_stop = false;
+    iam__mutex_init(&iam__jobs.lock);
+    iam__cond_init(&iam__jobs.wake);
+    iam__cond_init(&iam__jobs.done);
+    s = iam_setting_reg_uint32(iam__api, "threads",
+        "Number of worker threads (0 - by number of processors).",
+        &iam__threads);
+    iam_setting_set_range_uint32(s, 0, 1024);
+    s = iam_setting_reg_uint32(iam__api, "job_threads",
+        "Number of threads for asynchronous jobs "
+        "(0 - jobs run in the calling thread).", &iam__job_threads);
+    iam_setting_set_range_uint32(s, 0, 64);
+}
+
+void iam__worker_pool_exit(void) {
+    // Задания могут использовать пул, поэтому они завершаются первыми
+    iam__job_pool_stop();
+    iam__cond_destroy(&iam__jobs.done);
+    iam__cond_destroy(&iam__jobs.wake);
+    iam__mutex_destroy(&iam__jobs.lock);
+    iam__worker_pool_stop();
+    iam__cond_destroy(&iam__pool.done);
+    iam__cond_destroy(&iam__pool.wake);
+    iam__mutex_destroy(&iam__pool.lock);
+    iam__mutex_destroy(&iam__pool.run_lock);
+}
+
+void iam__worker_pool_start(void) {
+    size_t i, count = iam__threads ? iam__threads : iam__cpu_count();
+    iam__job_pool_start();
+    iam__worker_pool_stop();
+    // Вызывающий поток также участвует в обработке
+    if (count <= 1)
+        return;
+    iam__pool.threads = (iam__thread_t *)iam__malloc(
+        sizeof(iam__thread_t) * (count - 1));
+    if (iam__pool.threads == NULL) {
+        iam_logger_puts(iam__api, IAM_ERROR,
+            "Not enough memory to start worker threads.");
+        return;
+    }
+    for (i = 0; i < count - 1; i++) {
+        if (iam__thread_start(&iam__pool.threads[i], iam__worker_main, NULL))
+            break;
+        iam__pool.count++;
+    }
+    IAM_LOG_PUTF(iam__api, IAM_TRACE,
+        "Started worker threads: %d.", (int)iam__pool.count);
+}
+
+size_t iam__worker_pool_size(void) {
+    return iam__pool.count + 1;
+}
+
+void iam__worker_pool_run(size_t count, iam__task_fn fn, void *ctx) {
+    size_t i;
+    if (iam__pool.count == 0 || count <= 1 || iam__is_task) {
+        for (i = 0; i < count; i++)
+            fn(ctx, i);
+        return;
+    }
+    iam__mutex_lock(&iam__pool.run_lock);
+    iam__mutex_lock(&iam__pool.lock);
+    iam__pool.fn = fn;
+    iam__pool.ctx = ctx;
+    iam__pool.next = 0;
+    iam__pool.finished = 0;
+    iam__pool.total = count;
+    iam__cond_broadcast(&iam__pool.wake);
+    iam__worker_pool_drain();
+    while (iam__pool.finished < iam__pool.total)
+        iam__cond_wait(&iam__pool.done, &iam__pool.lock);
+    iam__pool.total = iam__pool.next = 0;
+    iam__mutex_unlock(&iam__pool.lock);
+    iam__mutex_unlock(&iam__pool.run_lock);
+}
+
+
+size_t iam_worker_count(void) {
+    return iam__worker_pool_size();
+}
+
+void iam_worker_run(size_t count, iam_task_fn fn, void *ctx) {
+    iam__worker_pool_run(count, fn, ctx);
+}
+
+iam_job_t *iam__worker_pool_submit(iam_job_fn fn, const void *ctx,
+    size_t size) {
+    iam_job_t *job = (iam_job_t *)iam__malloc(sizeof(iam_job_t) + size);
+    if (job == NULL)
+        return NULL;
+    job->fn = fn;
+    job->ctx = (void *)ctx;
+    if (size > 0) {
+        job->ctx = job + 1;
+        memcpy(job->ctx, ctx, size);
+    }
+    job->is_done = false;
+    job->next = NULL;
+    iam__mutex_lock(&iam__jobs.lock);
+    if (iam__jobs.count == 0) {
+        iam__mutex_unlock(&iam__jobs.lock);
+        fn(job->ctx);
+        job->is_done = true;
+        return job;
+    }
+    if (iam__jobs.tail == NULL)
+        iam__jobs.head = job;
+    else
+        iam__jobs.tail->next = job;
+    iam__jobs.tail = job;
+    iam__cond_signal(&iam__jobs.wake);
+    iam__mutex_unlock(&iam__jobs.lock);
+    return job;
+}
+
+iam_job_t *iam_job_submit(iam_job_fn fn, void *ctx) {
+    return iam__worker_pool_submit(fn, ctx, 0);
+}
+
+bool iam_job_is_done(iam_job_t *job) {
+    bool is_done;
+    iam__mutex_lock(&iam__jobs.lock);
+    is_done = job->is_done;
+    iam__mutex_unlock(&iam__jobs.lock);
+    return is_done;
+}
+
+void iam_job_wait(iam_job_t *job) {
+    if (job == NULL)
+        return;
+    iam__mutex_lock(&iam__jobs.lock);
+    while (!job->is_done)
+        iam__cond_wait(&iam__jobs.done, &iam__jobs.lock);
+    iam__mutex_unlock(&iam__jobs.lock);
+}
+
+void iam_job_free(iam_job_t *job) {
+    if (job == NULL)
+        return;
+    iam_job_wait(job);
+    iam__free(job);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __IAM_WORKER_POOL_H__
+#define __IAM_WORKER_POOL_H__
+
+#include <iam/worker.h>
+#include <common.h>
+#include <stddef.h>
+
+typedef iam_task_fn iam__task_fn;
+
+void iam__worker_pool_init(void);
+void iam__worker_pool_exit(void);
+void iam__worker_pool_start(void);
+
+size_t iam__worker_pool_size(void);
+void iam__worker_pool_run(size_t count, iam__task_fn fn, void *ctx);
+
+/*! Ставит задание в очередь; при size > 0 контекст копируется в задание
+    и функция получает указатель на копию.
+*/
+iam_job_t *iam__worker_pool_submit(iam_job_fn fn, const void *ctx,
+    size_t size);
+
+#endif
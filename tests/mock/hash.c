@@ -0,0 +1,11 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include "hash.h"
+
+DEFINE_FAKE_VOID_FUNC1(iam__hash_init, iam__hash_t *);
+DEFINE_FAKE_VALUE_FUNC3(int, iam__hash_put, iam__hash_t *, const char *,
+    void *);
+DEFINE_FAKE_VALUE_FUNC2(void *, iam__hash_get, const iam__hash_t *,
+    const char *);
+DEFINE_FAKE_VOID_FUNC1(iam__hash_free, iam__hash_t *);
\ No newline at end of file
@@ -0,0 +1,21 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#ifndef __IAM_HASH_H__
+#define __IAM_HASH_H__
+
+#include <memory.h>
+
+typedef struct {
+    void *slots;
+    size_t size, count;
+} iam__hash_t;
+
+DECLARE_FAKE_VOID_FUNC1(iam__hash_init, iam__hash_t *);
+DECLARE_FAKE_VALUE_FUNC3(int, iam__hash_put, iam__hash_t *, const char *,
+    void *);
+DECLARE_FAKE_VALUE_FUNC2(void *, iam__hash_get, const iam__hash_t *,
+    const char *);
+DECLARE_FAKE_VOID_FUNC1(iam__hash_free, iam__hash_t *);
+
+#endif
\ No newline at end of file
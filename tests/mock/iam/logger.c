@@ -13,4 +13,9 @@ void iam_logger_puts(iam_id_t id, iam_logger_level level,
 void iam_logger_putf(iam_id_t id, iam_logger_level level,
     const char *msg, ...) {
     iam_logger_put(id, level);
+}
+
+bool iam_logger_limit(iam_id_t id, iam_logger_level level,
+    iam_log_limit_t *limit) {
+    return true;
 }
\ No newline at end of file
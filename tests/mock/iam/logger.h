@@ -5,6 +5,8 @@
 #define __IAM_LOGGER_H__
 
 #include <iam/iam.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <time.h>
 #include <fff.h>
 
@@ -23,12 +25,39 @@ typedef struct {
     iam_id_t id;
     iam_logger_level level;
     const char *msg;
+    uint64_t ns;
 } iam_log_t;
 
 typedef void (*iam_log_save_fn)(iam_log_t *log);
 
+typedef struct {
+    iam_id_t id;
+    time_t time;
+    uint64_t ns;
+    iam_logger_level level;
+    const char *fmt;
+    const void *args;
+    size_t size;
+} iam_log_bin_t;
+
+typedef void (*iam_log_save_bin_fn)(const iam_log_bin_t *log);
+
+typedef struct iam_log_limit_s {
+    uint64_t tat;
+    uint64_t skipped;
+    uint64_t is_listed;
+    iam_id_t id;
+    iam_logger_level level;
+    struct iam_log_limit_s *next;
+} iam_log_limit_t;
+
 #define IAM_LOG_MAX_SIZE 512
 #define IAM_LOG_LEVELS IAM_ALL
+#define IAM_LOG_PUTS(id, level, msg) iam_logger_puts(id, level, msg)
+#define IAM_LOG_PUTF(id, level, ...) iam_logger_putf(id, level, __VA_ARGS__)
+#define IAM_LOG_PUTB(id, level, ...) iam_logger_putb(id, level, __VA_ARGS__)
+#define IAM_LOG_PUTF_LIMIT(id, level, ...) \
+    iam_logger_putf(id, level, __VA_ARGS__)
 
 DECLARE_FAKE_VOID_FUNC2(iam_logger_put, iam_id_t, iam_logger_level);
 
@@ -37,6 +66,17 @@ void iam_logger_puts(iam_id_t id, iam_logger_level level,
 void iam_logger_putf(iam_id_t id, iam_logger_level level,
     const char *msg, ...);
 
+void iam_logger_putb(iam_id_t id, iam_logger_level level,
+    const char *fmt, ...);
+size_t iam_logger_format_bin(char *buf, size_t size,
+    const iam_log_bin_t *log);
+const char *iam_logger_time_str(time_t time);
+bool iam_logger_is_on(iam_logger_level level);
+bool iam_logger_limit(iam_id_t id, iam_logger_level level,
+    iam_log_limit_t *limit);
+
 int iam_logger_reg_save(iam_id_t id, iam_logger_level filter,
     iam_log_save_fn save);
+int iam_logger_reg_save_bin(iam_id_t id, iam_logger_level filter,
+    iam_log_save_bin_fn save);
 #endif
\ No newline at end of file
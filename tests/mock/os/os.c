@@ -10,4 +10,6 @@ DEFINE_FAKE_VALUE_FUNC1(iam__finfo_t *, iam__dir_findnext, iam__dir_t *);
 DEFINE_FAKE_VALUE_FUNC1(const char *, iam__finfo_name, iam__finfo_t *);
 DEFINE_FAKE_VALUE_FUNC2(void *, iam__lib_find, iam__lib_t *, const char *);
 DEFINE_FAKE_VOID_FUNC1(iam__dir_close, iam__dir_t *);
-DEFINE_FAKE_VOID_FUNC1(iam__lib_close, iam__lib_t *);
\ No newline at end of file
+DEFINE_FAKE_VOID_FUNC1(iam__lib_close, iam__lib_t *);
+DEFINE_FAKE_VALUE_FUNC0(uint64_t, iam__clock_ns);
+DEFINE_FAKE_VOID_FUNC2(iam__localtime, time_t, struct tm *);
\ No newline at end of file
@@ -5,8 +5,12 @@
 #define __IAM_OS_H__
 
 #include <iam/iam.h>
+#include <stdint.h>
+#include <time.h>
 #include <fff.h>
 
+#define IAM__THREAD_LOCAL __thread
+
 typedef void iam__lib_t;
 typedef void iam__dir_t;
 typedef void iam__finfo_t;
@@ -19,5 +23,7 @@ DECLARE_FAKE_VALUE_FUNC1(const char *, iam__finfo_name, iam__finfo_t *);
 DECLARE_FAKE_VALUE_FUNC2(void *, iam__lib_find, iam__lib_t *, const char *);
 DECLARE_FAKE_VOID_FUNC1(iam__dir_close, iam__dir_t *);
 DECLARE_FAKE_VOID_FUNC1(iam__lib_close, iam__lib_t *);
+DECLARE_FAKE_VALUE_FUNC0(uint64_t, iam__clock_ns);
+DECLARE_FAKE_VOID_FUNC2(iam__localtime, time_t, struct tm *);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include <unity.h>
+#include <stdio.h>
+#include "../src/hash.h"
+
+int obj1, obj2, obj3;
+iam__hash_t hash;
+iam__hash_slot_t buf1[16], buf2[32];
+char keys[13][8];
+
+void setUp() {
+    iam__hash_init(&hash);
+    RESET_FAKE(iam__malloc);
+    RESET_FAKE(iam__free);
+}
+
+void tearDown() {}
+
+void test_HashInit_should_EmptyTable() {
+    TEST_ASSERT_NULL(hash.slots);
+    TEST_ASSERT_EQUAL_INT(0, hash.size);
+    TEST_ASSERT_EQUAL_INT(0, hash.count);
+    TEST_ASSERT_NULL(iam__hash_get(&hash, "key"));
+}
+
+void test_HashPut_should_OutOfMemory() {
+    int res;
+    iam__malloc_fake.return_val = NULL;
+
+    res = iam__hash_put(&hash, "key", &obj1);
+
+    TEST_ASSERT_EQUAL_INT(1, res);
+    TEST_ASSERT_NULL(hash.slots);
+    TEST_ASSERT_EQUAL_INT(0, hash.count);
+}
+
+void test_HashPut_should_ObjectsFound() {
+    iam__malloc_fake.return_val = buf1;
+
+    iam__hash_put(&hash, "alg1", &obj1);
+    iam__hash_put(&hash, "alg2", &obj2);
+
+    TEST_ASSERT_EQUAL_INT(1, iam__malloc_fake.call_count);
+    TEST_ASSERT_EQUAL_INT(16, hash.size);
+    TEST_ASSERT_EQUAL_INT(2, hash.count);
+    TEST_ASSERT_EQUAL_PTR(&obj1, iam__hash_get(&hash, "alg1"));
+    TEST_ASSERT_EQUAL_PTR(&obj2, iam__hash_get(&hash, "alg2"));
+    TEST_ASSERT_NULL(iam__hash_get(&hash, "alg3"));
+}
+
+void test_HashPut_should_ObjectReplaced() {
+    iam__malloc_fake.return_val = buf1;
+
+    iam__hash_put(&hash, "alg1", &obj1);
+    iam__hash_put(&hash, "alg1", &obj3);
+
+    TEST_ASSERT_EQUAL_INT(1, hash.count);
+    TEST_ASSERT_EQUAL_PTR(&obj3, iam__hash_get(&hash, "alg1"));
+}
+
+void test_HashPut_should_TableGrown() {
+    size_t i;
+    iam__malloc_fake.return_val = buf1;
+    for (i = 0; i < 12; i++) {
+        sprintf(keys[i], "key%d", (int)i);
+        iam__hash_put(&hash, keys[i], &keys[i]);
+    }
+    iam__malloc_fake.return_val = buf2;
+    sprintf(keys[12], "key12");
+
+    iam__hash_put(&hash, keys[12], &keys[12]);
+
+    TEST_ASSERT_EQUAL_INT(2, iam__malloc_fake.call_count);
+    TEST_ASSERT_EQUAL_INT(1, iam__free_fake.call_count);
+    TEST_ASSERT_EQUAL_PTR(buf1, iam__free_fake.arg0_val);
+    TEST_ASSERT_EQUAL_INT(32, hash.size);
+    TEST_ASSERT_EQUAL_INT(13, hash.count);
+    for (i = 0; i < 13; i++)
+        TEST_ASSERT_EQUAL_PTR(&keys[i], iam__hash_get(&hash, keys[i]));
+}
+
+void test_HashFree_should_EmptyTable() {
+    iam__malloc_fake.return_val = buf1;
+    iam__hash_put(&hash, "alg1", &obj1);
+
+    iam__hash_free(&hash);
+
+    TEST_ASSERT_EQUAL_INT(1, iam__free_fake.call_count);
+    TEST_ASSERT_EQUAL_PTR(buf1, iam__free_fake.arg0_val);
+    TEST_ASSERT_EQUAL_INT(0, hash.size);
+    TEST_ASSERT_NULL(iam__hash_get(&hash, "alg1"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_HashInit_should_EmptyTable);
+    RUN_TEST(test_HashPut_should_OutOfMemory);
+    RUN_TEST(test_HashPut_should_ObjectsFound);
+    RUN_TEST(test_HashPut_should_ObjectReplaced);
+    RUN_TEST(test_HashPut_should_TableGrown);
+    RUN_TEST(test_HashFree_should_EmptyTable);
+    return UNITY_END();
+}
\ No newline at end of file
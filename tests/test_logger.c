@@ -2,7 +2,10 @@
 // License: http://opensource.org/licenses/MIT
 
 #include <unity.h>
+#include <string.h>
 #include "../src/logger_manager.h"
+#include <iam/setting.h>
+#include <os/os.h>
 
 iam_id_t id;
 iam_log_t lbuf;
@@ -10,9 +13,39 @@ iam__log_store_t sbuf;
 
 extern char is_accumulation;
 extern iam__list_t iam__log_stores;
+extern iam__list_t iam__log_bin_stores;
 extern iam_logger_level iam_logger_filter;
+extern uint32_t iam__log_rate;
+extern uint32_t iam__log_burst;
+
+// Настройки ограничителя в тестах не регистрируются
+iam_class_t setting;
+const iam_type_t *const IAM_UINT32 = NULL;
+FAKE_VALUE_FUNC8(iam_variable_t *, iam_variable_reg, iam_class_t *, iam_id_t,
+	const iam_type_t *, const char *, const char *, void *, size_t, size_t);
+FAKE_VALUE_FUNC2(iam_setting_t *, iam_setting_reg, iam_variable_t *, void *);
+FAKE_VALUE_FUNC4(iam_variable_status, iam_variable_set_range_uint,
+	iam_class_t *, iam_variable_t *, uint64_t, uint64_t);
 
 FAKE_VOID_FUNC1(save, iam_log_t *);
+FAKE_VOID_FUNC1(save_bin, const iam_log_bin_t *);
+
+char text[IAM_LOG_MAX_SIZE];
+
+void save_text(iam_log_t *log) {
+	strcpy(text, log->msg);
+}
+
+void save_bin_text(const iam_log_bin_t *log) {
+	iam_logger_format_bin(text, sizeof(text), log);
+}
+
+// Форматирует аргументы по строке формата другого сообщения
+void save_bin_other_fmt(const iam_log_bin_t *log) {
+	iam_log_bin_t other = *log;
+	other.fmt = "%s|%d|%x|%f";
+	iam_logger_format_bin(text, sizeof(text), &other);
+}
 
 iam__log_store_t store = {
 	.id = NULL,
@@ -20,6 +53,19 @@ iam__log_store_t store = {
 	.save = save
 };
 
+iam__log_bin_store_t bin_store = {
+	.id = NULL,
+	.filter = 1,
+	.save = save_bin
+};
+
+void fill_time(time_t time, struct tm *tm) {
+	memset(tm, 0, sizeof(*tm));
+	tm->tm_mday = 2;
+	tm->tm_year = 124;
+	tm->tm_sec = (int)time % 60;
+}
+
 void setUp() {}
 
 void tearDown() {}
@@ -33,17 +79,41 @@ void print_three_message() {
 }
 
 void test_LoggerPut_should_IsAccumulationLogs() {
+	void *d[1] = { &store };
+	RESET_FAKE(save);
 	is_accumulation = 1;
 
 	print_three_message();
+	iam__log_stores.d = d;
+	iam__log_stores.count = 1;
+	iam__logger_manager_flush();
+
+	TEST_ASSERT_EQUAL_INT(0, iam__malloc_fake.call_count);
+	TEST_ASSERT_EQUAL_INT(3, save_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("t3", save_fake.arg0_val->msg);
+	TEST_ASSERT_EQUAL_INT(0, is_accumulation);
+}
 
-	TEST_ASSERT_EQUAL_INT(3, iam__list_append_fake.call_count);
+void test_LoggerPutf_should_NotAllocateMemory() {
+	void *d[1] = { &store };
+	iam__log_stores.d = d;
+	iam__log_stores.count = 1;
+	iam__logger_update_levels();
+	RESET_FAKE(save);
+	RESET_FAKE(iam__malloc);
+	is_accumulation = 0;
+
+	iam_logger_putf(id, 1, "t%d", 4);
+
+	TEST_ASSERT_EQUAL_INT(0, iam__malloc_fake.call_count);
+	TEST_ASSERT_EQUAL_INT(1, save_fake.call_count);
 }
 
 void test_LoggerPut_should_LogsSavedInStores() {
 	void *d[2] = { &store, &store };
 	iam__log_stores.d = d;
 	iam__log_stores.count = 2;
+	iam__logger_update_levels();
 	RESET_FAKE(save);
 	is_accumulation = 0;
 
@@ -53,6 +123,167 @@ void test_LoggerPut_should_LogsSavedInStores() {
 	TEST_ASSERT_EQUAL_INT(6, save_fake.call_count); // 3 * 2
 }
 
+void test_LoggerPutb_should_FormatForTextStores() {
+	void *d[1] = { &store };
+	iam__log_stores.d = d;
+	iam__log_stores.count = 1;
+	iam__logger_update_levels();
+	RESET_FAKE(save);
+	save_fake.custom_fake = save_text;
+	is_accumulation = 0;
+
+	iam_logger_putb(id, 1, "%s=%d %5.2f %%", "x", -7, 1.5);
+
+	TEST_ASSERT_EQUAL_INT(1, save_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("x=-7  1.50 %", text);
+}
+
+void test_LoggerPutb_should_PassArgsToBinaryStores() {
+	void *d[1] = { &bin_store };
+	iam__log_stores.count = 0;
+	iam__log_bin_stores.d = d;
+	iam__log_bin_stores.count = 1;
+	iam__logger_update_levels();
+	RESET_FAKE(save_bin);
+	save_bin_fake.custom_fake = save_bin_text;
+	is_accumulation = 0;
+
+	iam_logger_putb(id, 1, "%-*s|%.*s|%llx|%c|%hhd|%zu", 4, "ab", 2, "xyz",
+		0x1234567890ULL, 'q', 300, (size_t)42);
+	iam__log_bin_stores.count = 0;
+
+	TEST_ASSERT_EQUAL_INT(1, save_bin_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("ab  |xy|1234567890|q|44|42", text);
+}
+
+void test_LoggerFormatBin_should_ReplaceMismatchedArgs() {
+	void *d[1] = { &bin_store };
+	iam__log_stores.count = 0;
+	iam__log_bin_stores.d = d;
+	iam__log_bin_stores.count = 1;
+	iam__logger_update_levels();
+	RESET_FAKE(save_bin);
+	save_bin_fake.custom_fake = save_bin_other_fmt;
+	is_accumulation = 0;
+
+	iam_logger_putb(id, 1, "%d|%s|%d|%u", -7, "ab", -1, 5u);
+	iam__log_bin_stores.count = 0;
+
+	TEST_ASSERT_EQUAL_INT(1, save_bin_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("?|?|ffffffffffffffff|?", text);
+}
+
+void test_LoggerPutf_should_SkipLevelsNotInFilters() {
+	void *d[1] = { &store };
+	iam__log_stores.d = d;
+	iam__log_stores.count = 1;
+	iam__logger_update_levels();
+	RESET_FAKE(save);
+	is_accumulation = 0;
+
+	iam_logger_putf(id, 2, "t%d", 5);
+	iam_logger_putb(id, 2, "t%d", 6);
+	iam__log_stores.count = 0;
+	iam__logger_update_levels();
+	iam_logger_puts(id, 1, "t7");
+
+	TEST_ASSERT_EQUAL_INT(0, save_fake.call_count);
+}
+
+void test_LoggerTimeStr_should_FormatOncePerSecond() {
+	RESET_FAKE(iam__localtime);
+	iam__localtime_fake.custom_fake = fill_time;
+
+	iam_logger_time_str(5);
+	const char *res = iam_logger_time_str(5);
+
+	TEST_ASSERT_EQUAL_INT(1, iam__localtime_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("02.01.2024 00:00:05", res);
+	TEST_ASSERT_EQUAL_STRING("02.01.2024 00:00:06", iam_logger_time_str(6));
+	TEST_ASSERT_EQUAL_INT(2, iam__localtime_fake.call_count);
+}
+
+// 10 сообщений в секунду (шаг 100 мс), не больше 3 подряд
+void limit_setup() {
+	static void *d[1] = { &store };
+	iam__log_stores.d = d;
+	iam__log_stores.count = 1;
+	iam__logger_update_levels();
+	RESET_FAKE(save);
+	RESET_FAKE(iam__clock_ns);
+	save_fake.custom_fake = save_text;
+	is_accumulation = 0;
+	iam__log_rate = 10;
+	iam__log_burst = 3;
+	iam__clock_ns_fake.return_val = 1000000000;
+}
+
+void test_LoggerLimit_should_AllowBurstThenSuppress() {
+	iam_log_limit_t limit = { 0 };
+	int i, allowed = 0;
+	limit_setup();
+
+	for (i = 0; i < 5; i++)
+		allowed += iam_logger_limit(id, 1, &limit);
+	iam__logger_limit_exit();
+	iam__log_stores.count = 0;
+
+	TEST_ASSERT_EQUAL_INT(3, allowed);
+	TEST_ASSERT_EQUAL_INT(1, save_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("Suppressed 2 similar messages.", text);
+}
+
+void test_LoggerLimit_should_ReportSuppressedAfterRefill() {
+	iam_log_limit_t limit = { 0 };
+	int i;
+	limit_setup();
+
+	for (i = 0; i < 5; i++)
+		iam_logger_limit(id, 1, &limit);
+	TEST_ASSERT_FALSE(iam_logger_limit(id, 1, &limit));
+	iam__clock_ns_fake.return_val += 100000000;
+	TEST_ASSERT_TRUE(iam_logger_limit(id, 1, &limit));
+	TEST_ASSERT_FALSE(iam_logger_limit(id, 1, &limit));
+
+	TEST_ASSERT_EQUAL_INT(1, save_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("Suppressed 3 similar messages.", text);
+	TEST_ASSERT_EQUAL_UINT64(1, limit.skipped);
+	iam__logger_limit_exit();
+	iam__log_stores.count = 0;
+	TEST_ASSERT_EQUAL_INT(2, save_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("Suppressed 1 similar messages.", text);
+}
+
+void test_LoggerLimitExit_should_ReportOnlyOnce() {
+	iam_log_limit_t limit = { 0 };
+	int i;
+	limit_setup();
+
+	for (i = 0; i < 4; i++)
+		iam_logger_limit(id, 1, &limit);
+	iam__logger_limit_exit();
+	iam__logger_limit_exit();
+	iam__log_stores.count = 0;
+
+	TEST_ASSERT_EQUAL_INT(1, save_fake.call_count);
+	TEST_ASSERT_EQUAL_UINT64(0, limit.is_listed);
+	TEST_ASSERT_NULL(limit.next);
+}
+
+void test_LoggerLimit_should_AllowAllWhenRateIsZero() {
+	iam_log_limit_t limit = { 0 };
+	int i, allowed = 0;
+	limit_setup();
+	iam__log_rate = 0;
+
+	for (i = 0; i < 100; i++)
+		allowed += iam_logger_limit(id, 1, &limit);
+	iam__log_stores.count = 0;
+
+	TEST_ASSERT_EQUAL_INT(100, allowed);
+	TEST_ASSERT_EQUAL_INT(0, iam__clock_ns_fake.call_count);
+}
+
 void test_LoggerRegSave_should_ReturnNullIfObjectIsNull() {
 	int res;
 	IAM_RESET_APPEND(NULL, 0);
@@ -89,6 +320,16 @@ int main() {
 	UNITY_BEGIN();
 	RUN_TEST(test_LoggerPut_should_IsAccumulationLogs);
 	RUN_TEST(test_LoggerPut_should_LogsSavedInStores);
+	RUN_TEST(test_LoggerPutf_should_NotAllocateMemory);
+	RUN_TEST(test_LoggerPutb_should_FormatForTextStores);
+	RUN_TEST(test_LoggerPutb_should_PassArgsToBinaryStores);
+	RUN_TEST(test_LoggerFormatBin_should_ReplaceMismatchedArgs);
+	RUN_TEST(test_LoggerPutf_should_SkipLevelsNotInFilters);
+	RUN_TEST(test_LoggerTimeStr_should_FormatOncePerSecond);
+	RUN_TEST(test_LoggerLimit_should_AllowBurstThenSuppress);
+	RUN_TEST(test_LoggerLimit_should_ReportSuppressedAfterRefill);
+	RUN_TEST(test_LoggerLimitExit_should_ReportOnlyOnce);
+	RUN_TEST(test_LoggerLimit_should_AllowAllWhenRateIsZero);
     RUN_TEST(test_LoggerRegSave_should_ReturnNullIfObjectIsNull);
 	RUN_TEST(test_LoggerRegSave_should_ReturnNullIfNodeIsNull);
 	RUN_TEST(test_LoggerRegSave_should_FuncAdded);
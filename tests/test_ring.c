@@ -0,0 +1,113 @@
+// Copyright (c) 2024 Alexander Sekunov 
+// License: http://opensource.org/licenses/MIT
+
+#include <unity.h>
+#include <stdlib.h>
+#include <iam/ring.h>
+#include <memory.h>
+
+iam_ring_mode_t modes[] = { IAM_RING_SPSC, IAM_RING_MPSC };
+int items[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+void setUp() {
+    RESET_FAKE(iam__malloc);
+    RESET_FAKE(iam__free);
+    iam__malloc_fake.custom_fake = malloc;
+    iam__free_fake.custom_fake = free;
+}
+
+void tearDown() {}
+
+void test_RingCreate_should_OutOfMemory() {
+    iam__malloc_fake.custom_fake = NULL;
+    iam__malloc_fake.return_val = NULL;
+
+    TEST_ASSERT_NULL(iam_ring_create(4, sizeof(int), IAM_RING_SPSC));
+}
+
+void test_RingCreate_should_RejectZeroSizes() {
+    TEST_ASSERT_NULL(iam_ring_create(0, sizeof(int), IAM_RING_SPSC));
+    TEST_ASSERT_NULL(iam_ring_create(4, 0, IAM_RING_MPSC));
+    TEST_ASSERT_EQUAL_INT(0, iam__malloc_fake.call_count);
+}
+
+void test_RingPush_should_DropWhenFull() {
+    iam_ring_stats_t stats;
+    for (size_t i = 0; i < 2; i++) {
+        iam_ring_t *r = iam_ring_create(3, sizeof(int), modes[i]);
+
+        size_t res = iam_ring_push(r, items, 6);
+        iam_ring_stats(r, &stats);
+
+        TEST_ASSERT_EQUAL_INT(4, res);
+        TEST_ASSERT_EQUAL_INT(4, iam_ring_count(r));
+        TEST_ASSERT_EQUAL_INT(4, stats.pushed);
+        TEST_ASSERT_EQUAL_INT(2, stats.dropped);
+        TEST_ASSERT_EQUAL_INT(0, iam_ring_push(r, items, 1));
+        iam_ring_destroy(r);
+    }
+}
+
+void test_RingPop_should_ReadInOrderAcrossEnd() {
+    int out[8];
+    iam_ring_stats_t stats;
+    for (size_t i = 0; i < 2; i++) {
+        iam_ring_t *r = iam_ring_create(4, sizeof(int), modes[i]);
+        iam_ring_push(r, items, 3);
+        iam_ring_pop(r, out, 2);
+        iam_ring_push(r, items + 3, 3);
+
+        size_t res = iam_ring_pop(r, out, 8);
+        iam_ring_stats(r, &stats);
+
+        TEST_ASSERT_EQUAL_INT(4, res);
+        TEST_ASSERT_EQUAL_INT_ARRAY(items + 2, out, 4);
+        TEST_ASSERT_EQUAL_INT(0, iam_ring_count(r));
+        TEST_ASSERT_EQUAL_INT(6, stats.popped);
+        TEST_ASSERT_EQUAL_INT(4, stats.peak);
+        iam_ring_destroy(r);
+    }
+}
+
+void test_RingPeek_should_ReturnContiguousPart() {
+    size_t n;
+    const int *p;
+    for (size_t i = 0; i < 2; i++) {
+        iam_ring_t *r = iam_ring_create(4, sizeof(int), modes[i]);
+        TEST_ASSERT_NULL(iam_ring_peek(r, 4, &n));
+        TEST_ASSERT_EQUAL_INT(0, n);
+        iam_ring_push(r, items, 3);
+        iam_ring_pop(r, (int[3]){ 0 }, 3);
+        iam_ring_push(r, items + 3, 3);
+
+        p = (const int *)iam_ring_peek(r, 4, &n);
+
+        TEST_ASSERT_EQUAL_INT(1, n);
+        TEST_ASSERT_EQUAL_INT(4, p[0]);
+        iam_ring_release(r, n);
+        p = (const int *)iam_ring_peek(r, 1, &n);
+        TEST_ASSERT_EQUAL_INT(1, n);
+        TEST_ASSERT_EQUAL_INT(5, p[0]);
+        iam_ring_destroy(r);
+    }
+}
+
+void test_RingDestroy_should_FreeBuffers() {
+    iam_ring_t *r = iam_ring_create(4, sizeof(int), IAM_RING_MPSC);
+
+    iam_ring_destroy(r);
+
+    TEST_ASSERT_EQUAL_INT(3, iam__malloc_fake.call_count);
+    TEST_ASSERT_EQUAL_INT(3, iam__free_fake.call_count);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_RingCreate_should_OutOfMemory);
+    RUN_TEST(test_RingCreate_should_RejectZeroSizes);
+    RUN_TEST(test_RingPush_should_DropWhenFull);
+    RUN_TEST(test_RingPop_should_ReadInOrderAcrossEnd);
+    RUN_TEST(test_RingPeek_should_ReturnContiguousPart);
+    RUN_TEST(test_RingDestroy_should_FreeBuffers);
+    return UNITY_END();
+}
\ No newline at end of file
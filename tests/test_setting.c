@@ -35,6 +35,8 @@ void tearDown() {}
 	buf[0] = v; buf[1] = s;					\
 	RESET_FAKE(iam__malloc);				\
 	RESET_FAKE(iam__list_append);			\
+	RESET_FAKE(iam__hash_put);				\
+	RESET_FAKE(iam__list_remove);			\
 	SET_RETURN_SEQ(iam__malloc, buf, 2);	\
 	iam__list_append_fake.return_val = r;	\
 } while(0)
@@ -103,6 +105,46 @@ void test_SettingReg_should_ReturnOutOfMemoryWhenNode() {
 	TEST_ASSERT_EQUAL_INT(IAM_OUT_OF_MEMORY, setting.status.init);
 	TEST_ASSERT_EQUAL_INT(2, iam__malloc_fake.call_count);
 	TEST_ASSERT_EQUAL_INT(1, iam__list_append_fake.call_count);
+	TEST_ASSERT_EQUAL_INT(0, iam__hash_put_fake.call_count);
+}
+
+void test_SettingReg_should_AddToIndex() {
+	iam_setting_t *t;
+	IAM_RESET(&v, &s, 0);
+
+	t = iam_setting_reg_int32(id, name, desc, &data);
+
+	TEST_ASSERT_EQUAL_PTR(&s, t);
+	TEST_ASSERT_EQUAL_INT(1, iam__hash_put_fake.call_count);
+	TEST_ASSERT_EQUAL_PTR(&module.setting_index, iam__hash_put_fake.arg0_val);
+	TEST_ASSERT_EQUAL_STRING(name, iam__hash_put_fake.arg1_val);
+	TEST_ASSERT_EQUAL_PTR(&s, iam__hash_put_fake.arg2_val);
+	TEST_ASSERT_EQUAL_INT(0, iam__list_remove_fake.call_count);
+}
+
+void test_SettingReg_should_ReturnOutOfMemoryWhenIndex() {
+	iam_setting_t *t;
+	setting.status.init = IAM_SUCCESS_INIT;
+	IAM_RESET(&v, &s, 0);
+	iam__hash_put_fake.return_val = 1;
+
+	t = iam_setting_reg_int32(id, name, desc, &data);
+
+	TEST_ASSERT_NULL(t);
+	TEST_ASSERT_EQUAL_INT(IAM_OUT_OF_MEMORY, setting.status.init);
+	TEST_ASSERT_EQUAL_INT(1, iam__hash_put_fake.call_count);
+	TEST_ASSERT_EQUAL_INT(1, iam__list_remove_fake.call_count);
+	TEST_ASSERT_EQUAL_PTR(&module.settings, iam__list_remove_fake.arg0_val);
+	TEST_ASSERT_EQUAL_PTR(&s, iam__list_remove_fake.arg1_val);
+}
+
+void test_SettingFind_should_ReturnFromIndex() {
+	RESET_FAKE(iam__hash_get);
+	iam__hash_get_fake.return_val = &s;
+
+	TEST_ASSERT_EQUAL_PTR(&s, iam_setting_find(id, name));
+	TEST_ASSERT_EQUAL_PTR(&module.setting_index, iam__hash_get_fake.arg0_val);
+	TEST_ASSERT_EQUAL_STRING(name, iam__hash_get_fake.arg1_val);
 }
 
 void test_SettingRegArr_should_DataFilled() {
@@ -127,6 +169,7 @@ void test_SettingRegArr_should_MemoryAllocationIfValueIsNull() {
 	void *buf[3] = {&v, arr, &s};
 	RESET_FAKE(iam__malloc);
 	RESET_FAKE(iam__list_append); 
+	RESET_FAKE(iam__hash_put);
 	SET_RETURN_SEQ(iam__malloc, buf, 3);
 	iam__list_append_fake.return_val = 0;
 
@@ -440,6 +483,7 @@ void test_SettingSetMax_should_CallRealloc() {
 	RESET_FAKE(iam__malloc);
 	RESET_FAKE(iam__realloc);
 	RESET_FAKE(iam__list_append);
+	RESET_FAKE(iam__hash_put);
  	SET_RETURN_SEQ(iam__malloc, buf, 3);
 	iam__realloc_fake.return_val = b32;
 	iam__list_append_fake.return_val = 0;
@@ -554,6 +598,9 @@ int main() {
 	RUN_TEST(test_SettingReg_should_ReturnOutOfMemoryWhenObject1);
 	RUN_TEST(test_SettingReg_should_ReturnOutOfMemoryWhenObject2);
 	RUN_TEST(test_SettingReg_should_ReturnOutOfMemoryWhenNode);
+	RUN_TEST(test_SettingReg_should_AddToIndex);
+	RUN_TEST(test_SettingReg_should_ReturnOutOfMemoryWhenIndex);
+	RUN_TEST(test_SettingFind_should_ReturnFromIndex);
 	RUN_TEST(test_SettingRegArr_should_DataFilled);
 	RUN_TEST(test_SettingRegArr_should_MemoryAllocationIfValueIsNull);
     RUN_TEST(test_SettingRegBool_should_DataFilled);	